@@ -0,0 +1,284 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    LaserBenchmark.cpp
+    Purpose: Host (Linux) benchmark of slot detection accuracy against scan speed, on synthesized laser traces of 22 and 24 fret boards
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include <random>
+#include <string>
+#include "LaserTrace.h"
+#include "SlideModule.h"
+
+#define BENCHMARK_SCALE_LENGTH 647.7    //scale length (mm) of the synthesized boards (25.5")
+#define BENCHMARK_STEPS_PER_MM 100.0    //default slide steps per mm
+#define BENCHMARK_SLOT_WIDTH 0.6        //default width (mm) of a fret slot
+#define BENCHMARK_BEAM_WIDTH 0.2        //width (mm) of the laser beam where it crosses the board
+#define BENCHMARK_SLOT_TRANSMISSION 0.7 //fraction of the beam that gets through a slot wider than the beam
+#define BENCHMARK_LEAD_IN 20.0          //board (mm) before the nut, and unbroken beam (mm) before the board
+#define BENCHMARK_TAIL 30.0             //board (mm) after the last fret slot
+#define BENCHMARK_AMBIENT 42            //calibrated ambient response
+#define BENCHMARK_ACTIVE 1000           //calibrated active response
+#define BENCHMARK_NOISE 3.0             //default standard deviation of the ADC noise (counts)
+#define BENCHMARK_DRIFT 40              //default change in the ambient response (counts) from one end of the board to the other
+#define BENCHMARK_TRIALS 10             //default number of boards synthesized at each speed
+#define BENCHMARK_SEED 1                //seed of the first trial. Each trial at a speed has a different seed, repeated at every speed
+#define BENCHMARK_MAX_ERROR 1.0         //largest RMS position error (steps) for a speed to count as accurate
+
+
+/**
+    Parameters of the synthesized traces
+*/
+struct BoardSettings
+{
+    int frets = 22;                 //number of fret slots
+    double steps_per_mm = BENCHMARK_STEPS_PER_MM;
+    double slot_width = BENCHMARK_SLOT_WIDTH;   //mm
+    double noise = BENCHMARK_NOISE; //standard deviation of the ADC noise (counts)
+    double drift = BENCHMARK_DRIFT; //change in ambient response (counts) across the board
+    double period = ADC_SAMPLE_PERIOD / 10.0;   //microseconds between readings
+};
+
+
+/**
+    Accuracy of the slot detection at one scan speed, over all trials
+*/
+struct SpeedResult
+{
+    long slots = 0;                 //slots synthesized
+    long missed = 0;                //slots synthesized, but not detected
+    long phantoms = 0;              //slots detected where there weren't any
+    long boards = 0;                //boards whose end was detected
+    double error_sum = 0;           //sum of the position errors (steps) of the slots detected
+    double error_squares = 0;       //sum of the squared position errors
+    double max_error = 0;           //largest position error (steps)
+    int min_confidence = 100;       //lowest confidence of the slots detected
+};
+
+
+/**
+    Return the position (mm from the nut) of a fret slot, d = L(1 - 2^(-n/12))
+
+    @param int fret is the fret number (1 for the first fret)
+    @return double position is the distance from the nut (mm)
+*/
+double fret_position(int fret)
+{
+    return BENCHMARK_SCALE_LENGTH * (1 - pow(2.0, -fret / 12.0));
+}
+
+
+/**
+    Return the width of the overlap of two intervals
+
+    @param double a_start, a_end is the first interval
+    @param double b_start, b_end is the second interval
+    @return double overlap is the width they have in common (0 if none)
+*/
+double overlap(double a_start, double a_end, double b_start, double b_end)
+{
+    return max(0.0, min(a_end, b_end) - max(a_start, b_start));
+}
+
+
+/**
+    Synthesize the trace of a board scanned at a constant speed. The beam is unbroken before and after the board.
+    Across the board the sensor reads the ambient response (drifting linearly), plus the part of the beam that gets through 
+    any slot it overlaps, plus gaussian ADC noise. Like the sampler, each reading is stamped with the slide position 
+    when its conversion started (ADC_HOLD_TIME before the reading was held), rounded to the nearest step
+
+    @param const BoardSettings& settings are the board and sensor parameters
+    @param double speed is the scan speed (steps/second)
+    @param unsigned seed seeds the noise
+    @param std::vector<double>& centers is set to the true center of each slot (steps)
+    @return Trace trace is the synthesized trace
+*/
+Trace synthesize(const BoardSettings& settings, double speed, unsigned seed, std::vector<double>& centers)
+{
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> noise(0, settings.noise);
+
+    double mm = settings.steps_per_mm;
+    double board_start = BENCHMARK_LEAD_IN * mm;
+    double nut = board_start + BENCHMARK_LEAD_IN * mm;
+    double board_end = nut + (fret_position(settings.frets) + BENCHMARK_TAIL) * mm;
+    double half_slot = settings.slot_width * mm / 2;
+    double half_beam = BENCHMARK_BEAM_WIDTH * mm / 2;
+    centers.clear();
+    for (int fret = 1; fret <= settings.frets; fret++) { centers.push_back(nut + fret_position(fret) * mm); }
+
+    Trace trace;
+    trace.period = (uint16_t)(settings.period * 10 + 0.5);
+    trace.ambient = BENCHMARK_AMBIENT;
+    trace.active = BENCHMARK_ACTIVE;
+    trace.low_noise = trace.high_noise = settings.noise;
+    trace.complete = true;
+
+    double step = speed * settings.period / 1e6;    //distance (steps) between readings
+    size_t slot = 0;                //first slot the beam could still overlap
+    for (unsigned long k = 0; k * step < board_end + board_start; k++)
+    {
+        double x = k * step;
+        double level = BENCHMARK_ACTIVE;
+        if (x > board_start && x < board_end)
+        {
+            double ambient = BENCHMARK_AMBIENT + settings.drift * (x - board_start) / (board_end - board_start);
+            while (slot < centers.size() && centers[slot] + half_slot < x - half_beam) { slot++; }
+            double through = 0;     //fraction of the beam through a slot
+            for (size_t i = slot; i < centers.size() && centers[i] - half_slot < x + half_beam; i++)
+            {
+                through += overlap(centers[i] - half_slot, centers[i] + half_slot, x - half_beam, x + half_beam) / (2 * half_beam);
+            }
+            level = ambient + through * BENCHMARK_SLOT_TRANSMISSION * (BENCHMARK_ACTIVE - ambient);
+        }
+        long reading = lround(level + noise(generator));
+        TraceSample sample = { lround(x - speed * ADC_HOLD_TIME / 1e7), k, (int)constrain(reading, 0L, 1023L) };
+        trace.samples.push_back(sample);
+    }
+    return trace;
+}
+
+
+/**
+    Match the slots detected against the true slots, and accumulate the accuracy. A detected slot matches the nearest
+    true slot if it is within a slot width of it. Unmatched true slots are misses, and unmatched detections phantoms
+
+    @param const ReplayResult& result is the replay of a synthesized trace
+    @param const std::vector<double>& centers are the true centers of the slots (steps)
+    @param double tolerance is the furthest (steps) a detection can be from a slot to match it
+    @param SpeedResult& accuracy accumulates the matches
+*/
+void score(const ReplayResult& result, const std::vector<double>& centers, double tolerance, SpeedResult& accuracy)
+{
+    accuracy.slots += centers.size();
+    accuracy.boards += result.done ? 1 : 0;
+    size_t next = 0;                //next true slot that hasn't been matched
+    for (size_t i = 0; i < result.centers.size(); i++)
+    {
+        while (next < centers.size() && centers[next] < result.centers[i] - tolerance) { next++; accuracy.missed++; }
+        if (next == centers.size() || centers[next] > result.centers[i] + tolerance)
+        {
+            accuracy.phantoms++;
+            continue;
+        }
+        double error = result.centers[i] - centers[next++];
+        accuracy.error_sum += error;
+        accuracy.error_squares += error * error;
+        accuracy.max_error = max(accuracy.max_error, fabs(error));
+        accuracy.min_confidence = min(accuracy.min_confidence, result.confidences[i]);
+    }
+    accuracy.missed += centers.size() - next;
+}
+
+
+/**
+    Print how to use the tool
+*/
+void usage()
+{
+    printf("Usage: LaserBenchmark [-f <frets>] [-m <steps/mm>] [-w <slot mm>] [-n <noise>] [-d <drift>] [-p <period us>] [-t <trials>] [-s <speed,speed,...>]\n");
+    printf("  -f  number of frets (default both 22 and 24)\n");
+    printf("  -m  slide steps per mm (default %.0f)\n", BENCHMARK_STEPS_PER_MM);
+    printf("  -w  slot width in mm (default %.2f)\n", BENCHMARK_SLOT_WIDTH);
+    printf("  -n  standard deviation of the ADC noise in counts (default %.1f)\n", BENCHMARK_NOISE);
+    printf("  -d  ambient drift in counts across the board (default %d)\n", BENCHMARK_DRIFT);
+    printf("  -p  microseconds between readings (default %.1f)\n", ADC_SAMPLE_PERIOD / 10.0);
+    printf("  -t  boards synthesized at each speed (default %d)\n", BENCHMARK_TRIALS);
+    printf("  -s  scan speeds in steps/second (default 1000 doubling to 512000)\n");
+    printf("Exits with 1 if detection isn't accurate up to the slide's SLIDE_MAXIMUM_SPEED (%d steps/s)\n", SLIDE_MAXIMUM_SPEED);
+}
+
+
+int main(int argc, char** argv)
+{
+    BoardSettings settings;
+    std::vector<int> boards = { 22, 24 };
+    std::vector<double> speeds;
+    int trials = BENCHMARK_TRIALS;
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '-' || i + 1 >= argc) { usage(); return 1; }
+        char option = argv[i][1];
+        const char* value = argv[++i];
+        switch (option)
+        {
+            case 'f': boards = { atoi(value) }; break;
+            case 'm': settings.steps_per_mm = atof(value); break;
+            case 'w': settings.slot_width = atof(value); break;
+            case 'n': settings.noise = atof(value); break;
+            case 'd': settings.drift = atof(value); break;
+            case 'p': settings.period = atof(value); break;
+            case 't': trials = atoi(value); break;
+            case 's':
+            {
+                for (const char* s = value; s != NULL; s = strchr(s, ',')) { speeds.push_back(atof(*s == ',' ? ++s : s)); }
+                break;
+            }
+            default: usage(); return 1;
+        }
+    }
+    if (speeds.empty()) { for (double speed = 1000; speed <= 512000; speed *= 2) { speeds.push_back(speed); } }
+    if (trials < 1 || settings.steps_per_mm <= 0 || settings.period <= 0 || boards[0] < 1) { usage(); return 1; }
+
+    double tolerance = settings.slot_width * settings.steps_per_mm;
+    bool guard_failed = false;
+    for (size_t b = 0; b < boards.size(); b++)
+    {
+        settings.frets = boards[b];
+        printf("%d fret board: %.1f steps/mm, %.2fmm slots, noise %.1f, drift %.0f, %.1fus readings, %d trials\n", settings.frets,
+            settings.steps_per_mm, settings.slot_width, settings.noise, settings.drift, settings.period, trials);
+        printf("    steps/s     mm/s  readings/slot  missed %%  phantom %%  mean err  rms err  max err  min conf  end found %%\n");
+
+        double max_accurate = 0;    //fastest speed, with every slower speed accurate too
+        bool accurate = true;
+        for (size_t s = 0; s < speeds.size(); s++)
+        {
+            SpeedResult accuracy;
+            std::vector<double> centers;
+            for (int t = 0; t < trials; t++)
+            {
+                Trace trace = synthesize(settings, speeds[s], BENCHMARK_SEED + t, centers);
+                score(replay_trace(trace), centers, tolerance, accuracy);
+            }
+            long found = accuracy.slots - accuracy.missed;
+            double rms = found > 0 ? sqrt(accuracy.error_squares / found) : 0;
+            printf("  %9.0f  %7.1f  %13.1f  %8.2f  %9.2f  %8.3f  %7.3f  %7.3f  %8d  %11.0f\n", speeds[s], speeds[s] / settings.steps_per_mm,
+                settings.slot_width * settings.steps_per_mm / (speeds[s] * settings.period / 1e6),
+                100.0 * accuracy.missed / accuracy.slots, 100.0 * accuracy.phantoms / accuracy.slots,
+                found > 0 ? accuracy.error_sum / found : 0, rms, accuracy.max_error, found > 0 ? accuracy.min_confidence : 0,
+                100.0 * accuracy.boards / trials);
+
+            accurate = accurate && accuracy.missed == 0 && accuracy.phantoms == 0 && accuracy.boards == trials && rms <= BENCHMARK_MAX_ERROR;
+            if (accurate) { max_accurate = speeds[s]; }
+        }
+        printf("Accurate up to %.0f steps/s (no missed or phantom slots, end of board found, RMS error <= %.1f steps)\n\n", max_accurate, BENCHMARK_MAX_ERROR);
+        guard_failed = guard_failed || max_accurate < SLIDE_MAXIMUM_SPEED;
+    }
+    if (guard_failed) { printf("FAILED: detection isn't accurate up to SLIDE_MAXIMUM_SPEED (%d steps/s)\n", SLIDE_MAXIMUM_SPEED); }
+    return guard_failed ? 1 : 0;
+}
@@ -0,0 +1,258 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    LaserReplay.cpp
+    Purpose: Host (Linux) tool that captures laser traces from the robot, and replays them through the unmodified LaserModule slot detection
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "LaserTrace.h"
+
+#define CAPTURE_TIMEOUT 5           //seconds without any data from the robot before a capture is abandoned
+#define STARTUP_TIMEOUT 60          //most seconds to wait for the robot to finish calibrating, after opening the port resets it
+
+
+/**
+    Replay a trace, and report the slots found (with the time into the trace each was detected), 
+    and how long detection took on this computer
+
+    @param const Trace& trace is the trace to replay
+    @param int speedup replays every speedup'th reading only, as if the slide had scanned that many times faster
+    @param bool verbose indicates whether the LaserModule's own messages should be printed
+*/
+void replay(const Trace& trace, int speedup, bool verbose)
+{
+    const TraceSample& first = trace.samples.front();
+    const TraceSample& last = trace.samples.back();
+    double duration = (last.sequence - first.sequence) * (trace.period / 10.0) / speedup / 1e6;
+    printf("%zu readings over %ld steps (%.3fs at %.1f steps/s). %ld dropped while capturing\n", trace.samples.size(), 
+        last.position - first.position, duration, duration > 0 ? (last.position - first.position) / duration : 0.0, trace.dropped);
+    printf("Recorded AMBIENT %d, ACTIVE %d, triggers LOWER %d, UPPER %d, noise %.2f/%.2f\n", trace.ambient, trace.active, 
+        trace.lower_trigger, trace.upper_trigger, trace.low_noise, trace.high_noise);
+
+    ReplayResult result = replay_trace(trace, speedup, verbose);
+
+    printf("  slot      center  confidence  detected (ms)\n");
+    for (size_t i = 0; i < result.centers.size(); i++)
+    {
+        printf("  %4zu  %10.2f  %10d  %13.1f\n", i, result.centers[i], result.confidences[i], result.times[i]);
+    }
+    if (result.done) { printf("Detected %zu slots. End of board at %.1fms\n", result.centers.size(), result.end_time); }
+    else { printf("Detected %zu slots. Trace ended before the end of the board\n", result.centers.size()); }
+    printf("Host: %.3fms in detect_slots() for %ld readings (%.0fns each)\n", result.host_time * 1e3, result.replayed, 
+        result.replayed > 0 ? result.host_time * 1e9 / result.replayed : 0.0);
+}
+
+
+/**
+    Convert a baud rate to its termios constant
+
+    @param long baud is the baud rate
+    @return speed_t constant, or B0 if unsupported
+*/
+speed_t baud_constant(long baud)
+{
+    switch (baud)
+    {
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 500000: return B500000;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        default: return B0;
+    }
+}
+
+
+/**
+    Set a serial port to raw mode at the specified baud rate. Reads time out after 0.1s
+
+    @param int port is the open serial port
+    @param long baud is the baud rate
+    @return bool success
+*/
+bool set_baud(int port, long baud)
+{
+    termios options;
+    if (tcgetattr(port, &options) != 0 || baud_constant(baud) == B0) { return false; }
+    cfmakeraw(&options);
+    cfsetispeed(&options, baud_constant(baud));
+    cfsetospeed(&options, baud_constant(baud));
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 1;
+    return tcsetattr(port, TCSANOW, &options) == 0;
+}
+
+
+/**
+    Print text from the robot until a line containing the specified text arrives, or there's no text for timeout seconds
+
+    @param int port is the open serial port
+    @param const char* text is the text to wait for. NULL to print until the robot is quiet
+    @param int timeout is the seconds of quiet before giving up
+    @return bool found is true if the text arrived
+*/
+bool wait_for(int port, const char* text, int timeout)
+{
+    std::string line;
+    int quiet = 0;                      //tenths of a second without any data
+    char c;
+    while (quiet < timeout * 10)
+    {
+        if (read(port, &c, 1) != 1) { quiet++; continue; }
+        quiet = 0;
+        putchar(c);
+        if (c != '\n') { line += c; continue; }
+        if (text != NULL && line.find(text) != std::string::npos) { return true; }
+        line.clear();
+    }
+    return false;
+}
+
+
+/**
+    Capture a trace from the robot: arm the capture (lx), switch to CAPTURE_BAUD, and run slot detection (rd), 
+    saving everything received until the end of the trace
+
+    @param const char* device is the robot's serial port, e.g. /dev/ttyACM0
+    @param const char* path is the file to save the trace to
+    @param std::vector<uint8_t>& bytes is set to the bytes of the trace
+    @return bool success
+*/
+bool capture(const char* device, const char* path, std::vector<uint8_t>& bytes)
+{
+    int port = open(device, O_RDWR | O_NOCTTY);
+    if (port < 0 || !set_baud(port, SERIAL_BAUD))
+    {
+        fprintf(stderr, "Couldn't open %s\n", device);
+        return false;
+    }
+
+    //opening the port resets the Arduino, which then calibrates the robot. Wait for it to finish (if it reset)
+    wait_for(port, "Waiting for", STARTUP_TIMEOUT);
+    write(port, "lx\n", 3);
+    if (!wait_for(port, "Switching to", CAPTURE_TIMEOUT))
+    {
+        fprintf(stderr, "The robot didn't arm the capture\n");
+        close(port);
+        return false;
+    }
+    tcdrain(port);
+    usleep(100000);                     //let the robot finish switching baud
+    set_baud(port, CAPTURE_BAUD);
+    write(port, "rd\n", 3);
+
+    Trace trace;
+    uint8_t buffer[4096];
+    int quiet = 0;
+    while (!trace.complete && quiet < CAPTURE_TIMEOUT * 10)
+    {
+        ssize_t length = read(port, buffer, sizeof(buffer));
+        if (length <= 0) { quiet++; continue; }
+        quiet = 0;
+        bytes.insert(bytes.end(), buffer, buffer + length);
+        if (!parse_trace(bytes, trace)) { break; }
+    }
+
+    //the robot returns to SERIAL_BAUD at the end of the trace. Show what it printed after detection
+    set_baud(port, SERIAL_BAUD);
+    wait_for(port, NULL, 1);
+    close(port);
+    if (!trace.complete)
+    {
+        fprintf(stderr, "Capture ended before the end of the trace (%zu bytes received)\n", bytes.size());
+        return false;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL || fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size())
+    {
+        fprintf(stderr, "Couldn't write %s\n", path);
+        return false;
+    }
+    fclose(file);
+    printf("Saved %zu samples to %s\n", trace.samples.size(), path);
+    return true;
+}
+
+
+/**
+    Print how to use the tool
+*/
+void usage()
+{
+    printf("Usage: LaserReplay [-v] [-s <speedup>] <trace> [<trace> ...]\n");
+    printf("       LaserReplay [-v] [-s <speedup>] --capture <port> <trace>\n");
+    printf("  -v            print the LaserModule's own messages while replaying\n");
+    printf("  -s <speedup>  replay every <speedup>'th reading only, as if the slide had scanned that many times faster\n");
+    printf("  --capture     capture a trace from the robot on <port> (e.g. /dev/ttyACM0) with lx/rd, save it, then replay it\n");
+}
+
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    int speedup = 1;
+    const char* device = NULL;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0) { verbose = true; }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) { speedup = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) { device = argv[++i]; }
+        else if (argv[i][0] == '-') { usage(); return 1; }
+        else { paths.push_back(argv[i]); }
+    }
+    if (paths.empty() || speedup < 1 || (device != NULL && paths.size() != 1)) { usage(); return 1; }
+
+    int failures = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        std::vector<uint8_t> bytes;
+        if (device != NULL ? !capture(device, paths[i], bytes) : !read_file(paths[i], bytes))
+        {
+            if (device == NULL) { fprintf(stderr, "Couldn't read %s\n", paths[i]); }
+            failures++;
+            continue;
+        }
+        Trace trace;
+        printf("%s: ", paths[i]);
+        if (!parse_trace(bytes, trace) || trace.samples.empty())
+        {
+            printf("not a valid laser trace\n");
+            failures++;
+            continue;
+        }
+        if (!trace.complete) { printf("(truncated) "); }
+        replay(trace, speedup, verbose);
+        printf("\n");
+    }
+    return failures;
+}
@@ -0,0 +1,179 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    LaserTrace.cpp
+    Purpose: Parsing laser traces, and replaying them through the unmodified LaserModule slot detection
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include <chrono>
+#include "LaserTrace.h"
+#include "SlideModule.h"
+#include "AnalogSampler.h"
+
+ISR(ADC_vect);                      //the sampler's ADC interrupt, called once per replayed reading
+
+
+/**
+    Parse a trace out of the bytes received from the robot. Anything before the magic "LTRC" (e.g. text the robot 
+    printed before detection started) is skipped. Multi-byte values are little endian, as on the AVR (and x86/ARM)
+
+    @param const std::vector<uint8_t>& bytes are the bytes received
+    @param Trace& trace is set to the parsed trace
+    @return bool valid is false if the trace is corrupt (trace.complete says whether the end of it was found)
+*/
+bool parse_trace(const std::vector<uint8_t>& bytes, Trace& trace)
+{
+    trace = Trace();
+    size_t i = 0;
+    while (i + 4 <= bytes.size() && memcmp(&bytes[i], "LTRC", 4) != 0) { i++; }
+    if (i + TRACE_HEADER_LENGTH > bytes.size()) { return true; }   //no header yet
+
+    if (bytes[i + 4] != CAPTURE_VERSION)
+    {
+        fprintf(stderr, "Unsupported trace version %d (expected %d)\n", bytes[i + 4], CAPTURE_VERSION);
+        return false;
+    }
+    memcpy(&trace.period, &bytes[i + 5], 2);
+    memcpy(&trace.ambient, &bytes[i + 7], 2);
+    memcpy(&trace.active, &bytes[i + 9], 2);
+    memcpy(&trace.lower_trigger, &bytes[i + 11], 2);
+    memcpy(&trace.upper_trigger, &bytes[i + 13], 2);
+    memcpy(&trace.low_noise, &bytes[i + 15], 4);
+    memcpy(&trace.high_noise, &bytes[i + 19], 4);
+    i += TRACE_HEADER_LENGTH;
+
+    long position = 0;
+    unsigned long sequence = 0;
+    while (i + 4 <= bytes.size())
+    {
+        if (bytes[i] == CAPTURE_ESCAPE)
+        {
+            if (bytes[i + 1] == CAPTURE_END)
+            {
+                uint16_t dropped;
+                memcpy(&dropped, &bytes[i + 2], 2);
+                trace.dropped = dropped;
+                trace.complete = true;
+                return true;
+            }
+            if (bytes[i + 1] != CAPTURE_ABSOLUTE)
+            {
+                fprintf(stderr, "Corrupt trace: unknown record 0x%02X after %zu samples\n", bytes[i + 1], trace.samples.size());
+                return false;
+            }
+            if (i + 6 > bytes.size()) { break; }
+            int32_t absolute;
+            memcpy(&absolute, &bytes[i + 2], 4);
+            position = absolute;
+            i += 6;
+            continue;
+        }
+        position += (int8_t)bytes[i];
+        sequence += bytes[i + 1];
+        TraceSample sample = { position, sequence, bytes[i + 2] | (bytes[i + 3] << 8) };
+        trace.samples.push_back(sample);
+        i += 4;
+    }
+    return true;
+}
+
+
+/**
+    Read a whole file
+
+    @param const char* path is the file to read
+    @param std::vector<uint8_t>& bytes is set to the contents of the file
+    @return bool success
+*/
+bool read_file(const char* path, std::vector<uint8_t>& bytes)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) { return false; }
+    uint8_t buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) { bytes.insert(bytes.end(), buffer, buffer + length); }
+    fclose(file);
+    return true;
+}
+
+
+/**
+    Replay a trace through a fresh LaserModule, exactly as the robot would have run it: each reading is loaded into the
+    ADC register, the sampler's interrupt stamps it with the slide position, and detect_slots() is called after every reading.
+    The LaserModule starts from the calibration recorded in the trace, with the triggers this build places for it
+
+    @param const Trace& trace is the trace to replay
+    @param (optional) int speedup replays every speedup'th reading only, as if the slide had scanned that many times faster. Default 1
+    @param (optional) bool verbose indicates whether the LaserModule's own messages should be printed. Default false
+    @return ReplayResult result is the slots found (with the time into the trace each was detected), and how long detection 
+    took on this computer
+*/
+ReplayResult replay_trace(const Trace& trace, int speedup, bool verbose)
+{
+    ReplayResult result;
+    if (trace.samples.empty()) { return result; }
+    double period = trace.period / 10.0;    //microseconds between readings
+
+    Serial.echo = verbose;
+    SlideModule* slide = new SlideModule();
+    LaserModule* laser = new LaserModule(slide);
+    laser->set_calibration(trace.ambient, trace.active, trace.low_noise, trace.high_noise);
+
+    const TraceSample& first = trace.samples.front();
+    slide->motor->set_current_position(first.position);
+    laser->detect_slots(verbose);       //starts the sampler
+    for (size_t i = 0; i < trace.samples.size() && !laser->done(); i += speedup)
+    {
+        const TraceSample& sample = trace.samples[i];
+        const TraceSample& next = i + speedup < trace.samples.size() ? trace.samples[i + speedup] : sample;
+        shim_micros = (unsigned long)((sample.sequence - first.sequence) * period / speedup);
+        slide->motor->set_current_position(next.position);  //the interrupt stamps the position saved by the one before, and saves this for the next
+        ADC = sample.reading;
+        ADC_vect();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        laser->detect_slots(verbose);
+        result.host_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.replayed++;
+
+        while ((int)result.times.size() < laser->get_num_slots()) { result.times.push_back(shim_micros / 1000.0); }
+    }
+    for (int i = 0; i < laser->get_num_slots(); i++)
+    {
+        result.centers.push_back(laser->get_slot_center(i));
+        result.confidences.push_back(laser->get_slot_confidence(i));
+    }
+    result.done = laser->done();
+    result.end_time = shim_micros / 1000.0;
+
+    laser->reset();                     //stops the sampler, if the trace ended before the board did
+    Serial.echo = true;
+    delete laser;
+    delete slide;
+    return result;
+}
@@ -0,0 +1,91 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    LaserTrace.h
+    Purpose: Header for laser traces: parsing them, and replaying them through the unmodified LaserModule slot detection
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef LASER_TRACE_H
+#define LASER_TRACE_H
+
+#include <vector>
+#include <Arduino.h>                //after the standard headers, as it defines min() and max() macros
+#include "LaserModule.h"
+
+#define TRACE_HEADER_LENGTH 23      //bytes in the trace header, including the magic "LTRC"
+
+
+/**
+    A single laser reading from a trace
+*/
+struct TraceSample
+{
+    long position;                  //slide position when the reading was taken
+    unsigned long sequence;         //conversion number of the reading, counting from the start of the trace
+    int reading;                    //raw reading (0-1023)
+};
+
+
+/**
+    A laser trace (captured from the robot, or synthesized): the calibration detection started from, and every reading
+*/
+struct Trace
+{
+    uint16_t period = ADC_SAMPLE_PERIOD;    //time between conversions (tenths of a microsecond)
+    int16_t ambient = 0;            //AMBIENT_RESPONSE at the start of detection
+    int16_t active = 0;             //ACTIVE_RESPONSE at the start of detection
+    int16_t lower_trigger = 0;      //lower trigger at the start of detection
+    int16_t upper_trigger = 0;      //upper trigger at the start of detection
+    float low_noise = 0;            //calibrated noise with the laser off
+    float high_noise = 0;           //calibrated noise with the laser on
+    std::vector<TraceSample> samples;
+    long dropped = 0;               //samples the robot dropped during the capture
+    bool complete = false;          //whether the end of the trace was found
+};
+
+
+/**
+    The result of replaying a trace through a LaserModule
+*/
+struct ReplayResult
+{
+    std::vector<float> centers;     //center of each slot detected (steps)
+    std::vector<int> confidences;   //confidence (0-100) in each slot detected
+    std::vector<double> times;      //time into the trace (ms) each slot was detected
+    bool done = false;              //whether the end of the board was detected
+    double end_time = 0;            //time into the trace (ms) replaying stopped
+    long replayed = 0;              //number of readings replayed
+    double host_time = 0;           //seconds spent in detect_slots() on this computer
+};
+
+
+bool parse_trace(const std::vector<uint8_t>& bytes, Trace& trace);     //parse a trace out of the bytes received from the robot
+bool read_file(const char* path, std::vector<uint8_t>& bytes);         //read a whole file
+ReplayResult replay_trace(const Trace& trace, int speedup=1, bool verbose=false);  //run a trace through a fresh LaserModule
+
+#endif
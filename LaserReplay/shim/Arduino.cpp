@@ -0,0 +1,57 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    Arduino.cpp
+    Purpose: Host implementation of the Arduino shim: the register variables, Serial, and time (driven by LaserReplay)
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "Arduino.h"
+#include "EEPROM.h"
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+unsigned long shim_micros = 0;
+volatile uint8_t shim_ports[16];
+
+volatile uint8_t TCCR1A, TCCR1B, TCCR3A, TCCR3B, TCCR4A, TCCR4B, TCCR5A, TCCR5B, TIMSK1, TIMSK3, TIMSK4, TIMSK5, TIFR1;
+volatile uint16_t TCNT1, TCNT3, TCNT4, TCNT5, OCR1A, OCR3A, OCR4A, OCR5A;
+volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR2, SREG;
+volatile uint16_t ADC;
+volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL;
+volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF, PORTG, PORTH, PORTJ, PORTK, PORTL;
+volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF, DDRG, DDRH, DDRJ, DDRK, DDRL;
+volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+
+unsigned long millis() { return shim_micros / 1000; }
+unsigned long micros() { return shim_micros; }
+void delay(unsigned long ms) { shim_micros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { shim_micros += us; }
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) { return LOW; }
+int analogRead(uint8_t pin) { return ADC; }        //the last reading replayed
@@ -0,0 +1,141 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    Arduino.h
+    Purpose: Minimal host (Linux) stand-in for the Arduino core, so the RobotDriver modules compile unmodified for LaserReplay
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define MSBFIRST 1
+#define A0 54
+#define A1 55
+#define A14 68
+#define A15 69
+#define F_CPU 16000000UL
+
+#define abs(x) ((x)>0?(x):-(x))
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bit(b) (1UL << (b))
+
+
+/**
+    Just enough of the Arduino String class for the messages the modules build
+*/
+class String
+{
+public:
+    String(const char* s="") : text(s) {}
+    String(const std::string& s) : text(s) {}
+    String(char c) : text(1, c) {}
+    String(int x, unsigned char base=10) : text(std::to_string(x)) {}
+    String(unsigned int x, unsigned char base=10) : text(std::to_string(x)) {}
+    String(long x, unsigned char base=10) : text(std::to_string(x)) {}
+    String(unsigned long x, unsigned char base=10) : text(std::to_string(x)) {}
+    String(double x, unsigned char decimals=2) { char buffer[64]; snprintf(buffer, sizeof(buffer), "%.*f", decimals, x); text = buffer; }
+
+    String& operator+=(const String& s) { text += s.text; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+    friend String operator+(const String& a, const char* b) { return String(a.text + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.text); }
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+
+private:
+    std::string text;
+};
+
+
+/**
+    Serial output goes to stdout while echo is true. Nothing is ever received
+*/
+class HardwareSerial
+{
+public:
+    bool echo = true;                       //whether output is printed (LaserReplay turns it off unless verbose)
+
+    void begin(unsigned long baud) {}
+    void flush() { fflush(stdout); }
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t print(const String& s) { return echo ? printf("%s", s.c_str()) : 0; }
+    size_t print(const char* s) { return print(String(s)); }
+    size_t print(int x) { return print(String(x)); }
+    size_t print(long x) { return print(String(x)); }
+    size_t print(unsigned long x) { return print(String(x)); }
+    size_t print(double x, int decimals=2) { return print(String(x, decimals)); }
+    template<typename T> size_t println(const T& x) { return print(x) + print("\n"); }
+    size_t println(double x, int decimals=2) { return print(x, decimals) + print("\n"); }
+    size_t println() { return print("\n"); }
+    size_t write(uint8_t c) { return echo ? fwrite(&c, 1, 1, stdout) : 0; }
+    size_t write(const uint8_t* buffer, size_t length) { return echo ? fwrite(buffer, 1, length, stdout) : 0; }
+};
+
+extern HardwareSerial Serial;
+
+extern volatile uint8_t shim_ports[16];   //every pin is on a shim port, with no effect
+inline uint8_t digitalPinToPort(uint8_t pin) { return pin / 8; }
+inline uint8_t digitalPinToBitMask(uint8_t pin) { return 1 << (pin % 8); }
+inline volatile uint8_t* portOutputRegister(uint8_t port) { return &shim_ports[port]; }
+inline volatile uint8_t* portInputRegister(uint8_t port) { return &shim_ports[port]; }
+
+extern unsigned long shim_micros;           //current time of the replay. Advanced by LaserReplay as samples are replayed
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+#endif
@@ -0,0 +1,50 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    EEPROM.h
+    Purpose: Host stand-in for the EEPROM library. Nothing is stored, and reads return erased (0xFF) bytes
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef EEPROM_SHIM_H
+#define EEPROM_SHIM_H
+
+#include <stdint.h>
+#include <string.h>
+
+struct EEPROMClass
+{
+    uint8_t read(int address) { return 0xFF; }
+    void write(int address, uint8_t value) {}
+    void update(int address, uint8_t value) {}
+    template<typename T> T& get(int address, T& t) { memset(&t, 0xFF, sizeof(T)); return t; }
+    template<typename T> const T& put(int address, const T& t) { return t; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
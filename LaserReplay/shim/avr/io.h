@@ -0,0 +1,66 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    io.h
+    Purpose: Host stand-ins for the ATmega2560 registers used by the RobotDriver modules (plain variables)
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef AVR_IO_SHIM_H
+#define AVR_IO_SHIM_H
+
+#include <stdint.h>
+
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR3A, TCCR3B, TCCR4A, TCCR4B, TCCR5A, TCCR5B, TIMSK1, TIMSK3, TIMSK4, TIMSK5, TIFR1;
+extern volatile uint16_t TCNT1, TCNT3, TCNT4, TCNT5, OCR1A, OCR3A, OCR4A, OCR5A;
+extern volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR2, SREG;
+extern volatile uint16_t ADC;               //LaserReplay sets this to each recorded reading before running the ADC interrupt
+extern volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL;
+extern volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF, PORTG, PORTH, PORTJ, PORTK, PORTL;
+extern volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF, DDRG, DDRH, DDRJ, DDRK, DDRL;
+extern volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+
+#define WGM12 3
+#define WGM32 3
+#define CS10 0
+#define CS11 1
+#define CS31 1
+#define OCIE1A 1
+#define OCIE3A 1
+#define OCIE4A 1
+#define OCIE5A 1
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define REFS0 6
+#define MUX5 3
+
+#endif
@@ -0,0 +1,200 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    AnalogSampler.cpp
+    Purpose: Sample an analog pin from the free-running ADC interrupt into a position-stamped ring buffer
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "AnalogSampler.h"
+#include <util/atomic.h>
+
+AnalogSampler* AnalogSampler::active = NULL;
+
+
+/**
+    Constructor for an analog sampler. The ADC is left alone until start() is called
+
+    @param uint8_t pin is the analog pin to sample (A0-A15)
+*/
+AnalogSampler::AnalogSampler(uint8_t pin)
+{
+    channel = pin >= A0 ? pin - A0 : pin;
+    position = NULL;
+}
+
+
+/**
+    Start free-running conversions on the pin. Each sample is stamped with the value at position when its conversion started.
+    Any samples left in the buffer are discarded
+
+    @param const volatile long* position is the position to stamp samples with. It must only be updated by 
+    interrupts (e.g. StepGenerator::get_position_register()), as the ADC interrupt can't be interrupted while reading it
+*/
+void AnalogSampler::start(const volatile long* position)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        this->position = position;
+        head = tail = 0;
+        dropped = 0;
+        head_position = tail_position = start_position = *position;
+        jumped = false;
+        active = this;
+        running = true;
+
+        ADMUX = (1 << REFS0) | (channel & 0x07);                //AVcc reference, low bits of the channel
+        ADCSRB = channel & 0x08 ? (1 << MUX5) : 0;              //high bit of the channel. ADTS = 0 selects free-running mode
+        ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIE) | ADC_PRESCALER_BITS;  //start converting continuously
+    }
+}
+
+
+/**
+    Stop conversions, and put the ADC back the way analogRead() expects it. Samples already in the buffer can still be taken
+*/
+void AnalogSampler::stop()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        ADCSRA = (1 << ADEN) | ADC_PRESCALER_BITS;              //single conversions, no interrupt
+        ADCSRB = 0;
+        running = false;
+        if (active == this) { active = NULL; }
+    }
+}
+
+
+/**
+    Return whether or not conversions are running
+
+    @return bool running is true if the sampler is running, else false
+*/
+bool AnalogSampler::is_running()
+{
+    return running;
+}
+
+
+/**
+    Remove the oldest sample from the buffer
+
+    @param long* position is set to the position the sample was taken at
+    @param int* sample is set to the sample (0-1023)
+    @param (optional) uint8_t* sequence is set to the conversion sequence number of the sample, which counts up by one 
+    every ADC_SAMPLE_PERIOD. Gaps of more than one mean samples were dropped. Default NULL (not needed)
+    @return bool taken is true if a sample was taken, or false if the buffer was empty
+*/
+bool AnalogSampler::take(long* position, int* sample, uint8_t* sequence)
+{
+    if (tail == head) { return false; }
+    uint16_t entry = entries[tail];             //the interrupt never writes to the tail, so no need to block it
+    int8_t delta = (int8_t) (entry >> 8) >> 2;  //sign extend the high 6 bits
+    if (delta == SAMPLE_JUMP)
+    {
+        tail_position = jump_position;          //the interrupt won't write another jump until this one is cleared
+        jumped = false;
+    }
+    else
+    {
+        tail_position += delta;
+    }
+    *position = tail_position;
+    *sample = entry & 0x03FF;
+    if (sequence != NULL) { *sequence = sequences[tail]; }
+    tail = (tail + 1) & (SAMPLE_BUFFER_LENGTH - 1);
+    return true;
+}
+
+
+/**
+    Return the number of samples waiting in the buffer
+
+    @return uint8_t available is the number of samples that can be taken
+*/
+uint8_t AnalogSampler::available()
+{
+    return (head - tail) & (SAMPLE_BUFFER_LENGTH - 1);
+}
+
+
+/**
+    Return the number of samples dropped because the buffer was full since start() was called
+
+    @return unsigned int dropped is the number of dropped samples
+*/
+unsigned int AnalogSampler::get_dropped()
+{
+    unsigned int count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        count = dropped;
+    }
+    return count;
+}
+
+
+/**
+    Store the completed conversion in the ring buffer of the running sampler, stamped with the position when it started.
+    The next conversion starts as this interrupt is raised, so the current position is saved for the next sample
+*/
+void AnalogSampler::handle_interrupt()
+{
+    AnalogSampler* sampler = active;
+    int sample = ADC;                           //read the result first, before the next conversion overwrites it
+    if (sampler == NULL) { return; }
+
+    long position = sampler->start_position;    //position near this sample's hold, rather than now (11.5 ADC clocks later)
+    sampler->start_position = *sampler->position;
+    uint8_t sequence = sampler->sequence++;
+    uint8_t next = (sampler->head + 1) & (SAMPLE_BUFFER_LENGTH - 1);
+    if (next == sampler->tail)                  //buffer is full
+    {
+        sampler->dropped++;
+        return;
+    }
+    long delta = position - sampler->head_position;
+    if (delta < -SAMPLE_MAX_DELTA || delta > SAMPLE_MAX_DELTA)     //moved too far to store in the entry
+    {
+        if (sampler->jumped)                    //the last jump hasn't been taken yet
+        {
+            sampler->dropped++;
+            return;
+        }
+        sampler->jump_position = position;
+        sampler->jumped = true;
+        delta = SAMPLE_JUMP;
+    }
+    sampler->head_position = position;
+    sampler->entries[sampler->head] = (sample & 0x03FF) | ((uint16_t) delta << 10);
+    sampler->sequences[sampler->head] = sequence;
+    sampler->head = next;
+}
+
+
+//conversion complete interrupt of the ADC
+ISR(ADC_vect) { AnalogSampler::handle_interrupt(); }
@@ -0,0 +1,117 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    AnalogSampler.h
+    Purpose: Header for sampling an analog pin from the free-running ADC interrupt
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef ANALOG_SAMPLER_H
+#define ANALOG_SAMPLER_H
+
+#include <Arduino.h>
+
+#define SAMPLE_BUFFER_LENGTH 64                 //number of (position, sample) pairs the ring buffer holds. Must be a power of 2
+#define SAMPLE_MAX_DELTA 31                     //largest position change (steps) between buffered samples stored in the entry itself (6 bit signed)
+#define SAMPLE_JUMP -32                         //position change stored in an entry whose position is held separately, as it moved too far
+#define ADC_PRESCALER_BITS 0x07                 //ADPS2:0 bits for an ADC clock of 16MHz/128 (the Arduino default), i.e. a sample every 104us
+#define ADC_SAMPLE_PERIOD 1040                  //time between free-running samples (tenths of a microsecond), i.e. 13 ADC clocks at 16MHz/128
+#define ADC_HOLD_TIME 120                       //time from the start of a conversion to its sample-and-hold (tenths of a microsecond), i.e. 1.5 ADC clocks
+
+
+/**
+    The AnalogSampler class samples an analog pin continuously in the background, using the ADC in free-running mode.
+    Each time a conversion completes, the ADC interrupt stamps the sample with a position (e.g. the step position 
+    of a StepGenerator), and pushes the pair into a ring buffer. The foreground then consumes the pairs with take() 
+    at its own pace, so the sample rate doesn't depend on how fast the main loop runs.
+    In free-running mode the input is held 1.5 ADC clocks after a conversion starts, but the interrupt only runs when it 
+    completes (11.5 clocks, ~92us later), which at speed would shift every sample along the board. So the interrupt 
+    saves the position as the next conversion starts, and stamps that onto the next sample instead. Each sample is then 
+    paired with the position ADC_HOLD_TIME before it was actually taken at, i.e. within a step at SLIDE_MAXIMUM_SPEED.
+
+    The ADC can only convert one pin at a time, so analogRead() must not be used while the sampler is running.
+    If the buffer fills up, new samples are dropped (and counted) until there is room again.
+    To save SRAM, each entry packs the 10-bit sample with the change in position since the previous entry (6 bits). 
+    That covers 300000 steps/second at the ADC sample rate, so only a jump (e.g. set_position() while sampling) 
+    is too far, and its position is held separately. Only one jump can wait in the buffer, so a second is dropped.
+    Every conversion (dropped or not) advances an 8-bit sequence number, so gaps can be found from the samples taken.
+
+    Example Usage:
+
+    ```
+    AnalogSampler* sampler = new AnalogSampler(A15);
+
+    setup()
+    {
+        sampler->start(slide->get_position_register());    //start sampling, stamping samples with the slide position
+    }
+
+    loop()
+    {
+        long position;
+        int sample;
+        while (sampler->take(&position, &sample)) { Serial.println(String(position) + " " + String(sample)); }
+    }
+    ```
+*/
+class AnalogSampler
+{
+public:
+    //constructor for a sampler on the specified analog pin (e.g. A15)
+    AnalogSampler(uint8_t pin);
+
+    void start(const volatile long* position);  //start free-running conversions, stamping each sample with the value at position
+    void stop();                                //stop conversions, and restore the ADC for analogRead()
+    bool is_running();                          //return whether or not conversions are running
+    bool take(long* position, int* sample,      //remove the oldest (position, sample) pair from the buffer. Return false if it is empty
+        uint8_t* sequence=NULL);
+    uint8_t available();                        //return the number of pairs waiting in the buffer
+    unsigned int get_dropped();                 //return the number of samples dropped because the buffer was full since start()
+
+    static void handle_interrupt();             //called by the ADC conversion complete interrupt. Store the sample
+
+private:
+    uint8_t channel;                            //ADC channel (0-15) of the pin
+    bool running = false;                       //whether or not conversions are running
+    const volatile long* position;              //position stamped onto each sample. Read from the interrupt
+
+    volatile uint16_t entries[SAMPLE_BUFFER_LENGTH];    //buffered samples (low 10 bits), and the change in position since the previous entry (high 6 bits)
+    volatile uint8_t sequences[SAMPLE_BUFFER_LENGTH];   //conversion sequence number of each buffered sample
+    volatile uint8_t sequence = 0;              //sequence number of the next conversion
+    volatile uint8_t head = 0;                  //index the interrupt writes the next sample to
+    volatile uint8_t tail = 0;                  //index of the oldest sample in the buffer
+    volatile unsigned int dropped = 0;          //number of samples dropped because the buffer was full
+    long head_position = 0;                     //position of the newest entry. Only used by the interrupt
+    long start_position = 0;                    //position when the conversion in progress started. Only used by the interrupt
+    long tail_position = 0;                     //position of the last entry taken. Only used by take()
+    volatile long jump_position = 0;            //position of the entry marked SAMPLE_JUMP
+    volatile bool jumped = false;               //whether an entry marked SAMPLE_JUMP is waiting in the buffer
+
+    static AnalogSampler* active;               //sampler currently running, for dispatching the interrupt (there is only one ADC)
+};
+
+#endif
@@ -0,0 +1,454 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    BoardCatalog.cpp
+    Purpose: Class implementation for the catalog of fretboard models, and fitting detected slots to them
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "BoardCatalog.h"
+
+//every board the robot can process
+const BoardModel BOARD_MODELS[NUM_BOARD_MODELS] =
+{
+    { "22 fret", 22 },
+    { "24 fret", 24 },
+};
+
+
+/**
+    Constructor for the board catalog. No board is matched until fit() is called
+*/
+BoardCatalog::BoardCatalog()
+{
+    matched = false;
+}
+
+
+/**
+    Set the range the scale length of the boards (in steps, i.e. scale length times the slide's steps/mm) must fit within.
+    Fits are only found within the range, so it must be narrower than a semitone (BOARD_MAX_SCALE_RATIO), or the frets 
+    couldn't be told apart. A range of 0 clears it, so no board matches until it is set again
+
+    @param long min_scale is the shortest scale length (steps). 0 to clear the range
+    @param long max_scale is the longest scale length (steps)
+    @return bool valid is false if the range was rejected (and left unchanged)
+*/
+bool BoardCatalog::set_scale_range(long min_scale, long max_scale)
+{
+    if (min_scale == 0 && max_scale == 0)
+    {
+        this->min_scale = this->max_scale = 0;
+        return true;
+    }
+    if (min_scale <= 0 || max_scale < min_scale || max_scale > min_scale * BOARD_MAX_SCALE_RATIO) { return false; }
+    this->min_scale = min_scale;
+    this->max_scale = max_scale;
+    return true;
+}
+
+
+/**
+    Return the shortest scale length allowed
+
+    @return long min_scale is the shortest scale length (steps), or 0 if the range isn't set
+*/
+long BoardCatalog::get_min_scale()
+{
+    return min_scale;
+}
+
+
+/**
+    Return the longest scale length allowed
+
+    @return long max_scale is the longest scale length (steps), or 0 if the range isn't set
+*/
+long BoardCatalog::get_max_scale()
+{
+    return max_scale;
+}
+
+
+/**
+    Fit the detected slots to every board model, and keep the best fit. A model matches if at most BOARD_MAX_MISSING of its 
+    frets are missing. Each pair of neighbouring slots is tried as every pair of frets (next to each other, or with one 
+    missing between) whose spacing gives a scale length in the range, and the fit is refined from there. A pair that already
+    fits the best fit of the model is skipped, as it would only find the same fit again
+
+    @param SlotTable* slots are the slots detected on the board
+    @param (optional) long board_start is the position (steps) where the board started. Default LONG_MIN (unknown)
+    @param (optional) long board_end is the position (steps) where the board ended. Default LONG_MAX (unknown)
+    @return bool matched is true if a model matched the slots
+*/
+bool BoardCatalog::fit(SlotTable* slots, long board_start, long board_end)
+{
+    best = BoardFit();
+    matched = false;
+    alternative = NO_BOARD_MODEL;
+    this->board_start = board_start;
+    this->board_end = board_end;
+    if (min_scale == 0 || slots->size() < 2) { return false; }
+
+    int inliers[NUM_BOARD_MODELS];          //slots fitted by the best fit of each model
+    int missing[NUM_BOARD_MODELS];          //frets missing from the best fit of each model
+    float semitone = pow(2.0, -1 / 12.0);   //ratio between the distances of neighbouring frets from the bridge
+    for (int model = 0; model < NUM_BOARD_MODELS; model++)
+    {
+        int frets = BOARD_MODELS[model].frets;
+        BoardFit model_best;
+        for (int i = 0; i + 1 < slots->size(); i++)
+        {
+            float first = slots->get_center(i);
+            float second = slots->get_center(i + 1);
+            for (int gap = 1; gap <= 2; gap++)
+            {
+                float remaining = semitone;                         //2^(-fret/12), i.e. distance from the fret to the bridge as a fraction of the scale
+                float gap_fraction = 1 - pow(2.0, -gap / 12.0);     //distance from a fret to the one gap frets past it, as a fraction of its distance to the bridge
+                for (int fret = 1; fret + gap <= frets; fret++, remaining *= semitone)
+                {
+                    float scale = (second - first) / (remaining * gap_fraction);
+                    if (scale < min_scale || scale > max_scale) { continue; }
+                    if (model_best.model != NO_BOARD_MODEL && fits_fret(&model_best, first, fret) && fits_fret(&model_best, second, fret + gap)) { continue; }
+
+                    BoardFit result;
+                    fit_model(slots, model, first - scale * (1 - remaining), scale, &result);
+                    if (is_better(&result, &model_best)) { model_best = result; }
+                }
+            }
+        }
+        inliers[model] = model_best.inliers;
+        missing[model] = model_best.missing;
+        if (is_better(&model_best, &best)) { best = model_best; }
+    }
+    if (best.model == NO_BOARD_MODEL) { return false; }
+
+    //another model that fits the same slots could be the board just as well (e.g. a 24 fret board with the last 2 undetected)
+    for (int model = 0; model < NUM_BOARD_MODELS; model++)
+    {
+        if (model != best.model && inliers[model] == best.inliers && missing[model] <= BOARD_MAX_MISSING)
+        {
+            alternative = model;
+            alternative_missing = missing[model];
+        }
+    }
+
+    matched = best.missing <= BOARD_MAX_MISSING;
+    return matched;
+}
+
+
+/**
+    Fit the slots to a single board model: assign each slot to the nearest fret, fit the nut and scale by least squares,
+    and repeat with the new fit. Finally, slots too far from their fret are made outliers, and the fit is repeated without them
+
+    @param SlotTable* slots are the slots detected on the board
+    @param int model is the index of the model in the catalog
+    @param float nut is the initial guess of the nut position (steps)
+    @param float scale is the initial guess of the scale length (steps)
+    @param BoardFit* result is set to the fit
+*/
+void BoardCatalog::fit_model(SlotTable* slots, int model, float nut, float scale, BoardFit* result)
+{
+    int frets = BOARD_MODELS[model].frets;
+    result->model = model;
+    result->nut = nut;
+    result->scale = scale;
+    for (int i = 0; i < BOARD_FIT_ITERATIONS; i++)
+    {
+        assign_frets(slots, frets, result->nut, result->scale, result);
+        if (!least_squares(slots, result))
+        {
+            result->model = NO_BOARD_MODEL;
+            return;
+        }
+    }
+
+    //drop any slots too far from their fret, and fit again without them
+    float tolerance = BOARD_FIT_TOLERANCE * result->scale;
+    for (int i = 0; i < slots->size(); i++)
+    {
+        if (result->frets[i] == 0) { continue; }
+        float error = slots->get_center(i) - (result->nut + result->scale * fret_fraction(result->frets[i]));
+        if (fabs(error) > tolerance) { result->frets[i] = 0; }
+    }
+    if (!least_squares(slots, result))
+    {
+        result->model = NO_BOARD_MODEL;
+        return;
+    }
+
+    //count the fit
+    result->inliers = 0;
+    float squares = 0;
+    for (int i = 0; i < slots->size(); i++)
+    {
+        if (result->frets[i] == 0) { continue; }
+        float error = slots->get_center(i) - (result->nut + result->scale * fret_fraction(result->frets[i]));
+        squares += error * error;
+        result->inliers++;
+    }
+    result->rms = sqrt(squares / result->inliers);
+    result->outliers = slots->size() - result->inliers;
+    result->missing = frets - result->inliers;
+    if (!is_possible(slots, result)) { result->model = NO_BOARD_MODEL; }
+}
+
+
+/**
+    Assign each slot to the nearest fret of the model, given the nut position and scale length.
+    If two slots are assigned to the same fret, the nearer one keeps it, and the other is an outlier
+
+    @param SlotTable* slots are the slots detected on the board
+    @param int frets is the number of frets on the model
+    @param float nut is the position (steps) of the nut
+    @param float scale is the scale length (steps)
+    @param BoardFit* result records the fret of each slot (0 if none)
+*/
+void BoardCatalog::assign_frets(SlotTable* slots, int frets, float nut, float scale, BoardFit* result)
+{
+    int previous = -1;                      //index of the last slot assigned a fret
+    for (int i = 0; i < slots->size(); i++)
+    {
+        //invert d = L(1 - 2^(-n/12)) for the fret number
+        float remaining = 1 - (slots->get_center(i) - nut) / scale;
+        int fret = remaining > 0 ? (int)floor(-12 * log(remaining) / log(2.0) + 0.5) : 0;
+        result->frets[i] = fret >= 1 && fret <= frets ? fret : 0;
+        if (result->frets[i] == 0) { continue; }
+
+        //slots are in order, so a fret assigned twice is assigned to consecutive slots
+        if (previous >= 0 && result->frets[previous] == fret)
+        {
+            float expected = nut + scale * fret_fraction(fret);
+            if (fabs(slots->get_center(i) - expected) < fabs(slots->get_center(previous) - expected)) { result->frets[previous] = 0; }
+            else { result->frets[i] = 0; continue; }
+        }
+        previous = i;
+    }
+}
+
+
+/**
+    Fit the nut position and scale length to the slots assigned to frets, i.e. minimize the squared distances 
+    between each slot and nut + scale * fret_fraction(fret)
+
+    @param SlotTable* slots are the slots detected on the board
+    @param BoardFit* result has the fret of each slot, and is set to the fitted nut and scale
+    @return bool fitted is false if too few frets were assigned to fit
+*/
+bool BoardCatalog::least_squares(SlotTable* slots, BoardFit* result)
+{
+    //positions are taken relative to the first slot, to keep the sums well within float precision
+    float origin = slots->get_center(0);
+    float n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < slots->size(); i++)
+    {
+        if (result->frets[i] == 0) { continue; }
+        float x = fret_fraction(result->frets[i]);
+        float y = slots->get_center(i) - origin;
+        n++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    float determinant = n * sxx - sx * sx;
+    if (n < 2 || determinant <= 0) { return false; }
+
+    result->scale = (n * sxy - sx * sy) / determinant;
+    result->nut = origin + (sy - result->scale * sx) / n;
+    return result->scale > 0;
+}
+
+
+/**
+    Check that a fit could be the board: its scale length is in the range, and every fret without a slot is on the board,
+    i.e. after where the board started, and before where it ended. A fret off the board means the model has too many frets
+
+    @param SlotTable* slots are the slots detected on the board
+    @param BoardFit* result is the fit to check
+    @return bool possible is true if the fit could be the board
+*/
+bool BoardCatalog::is_possible(SlotTable* slots, BoardFit* result)
+{
+    if (result->scale < min_scale * (1 - BOARD_FIT_TOLERANCE) || result->scale > max_scale * (1 + BOARD_FIT_TOLERANCE)) { return false; }
+
+    uint32_t fitted = 0;                    //bit mask of the frets with a slot (bit n-1 for fret n)
+    for (int i = 0; i < slots->size(); i++)
+    {
+        if (result->frets[i] != 0) { fitted |= 1UL << (result->frets[i] - 1); }
+    }
+    for (int fret = 1; fret <= BOARD_MODELS[result->model].frets; fret++)
+    {
+        if (fitted & (1UL << (fret - 1))) { continue; }
+        float position = result->nut + result->scale * fret_fraction(fret);
+        if (position < board_start || position > board_end) { return false; }
+    }
+    return true;
+}
+
+
+/**
+    Check if a position is within the fit tolerance of a fret of a fit
+
+    @param BoardFit* result is the fit
+    @param float position is the position (steps) to check
+    @param int fret is the fret number
+    @return bool fits is true if the position is within the tolerance of the fitted fret position
+*/
+bool BoardCatalog::fits_fret(BoardFit* result, float position, int fret)
+{
+    return fabs(position - (result->nut + result->scale * fret_fraction(fret))) <= BOARD_FIT_TOLERANCE * result->scale;
+}
+
+
+/**
+    Compare two fits. The better fit has more slots fitted, then fewer frets missing, then a smaller RMS error
+
+    @param BoardFit* a is the first fit
+    @param BoardFit* b is the second fit
+    @return bool better is true if a is better than b
+*/
+bool BoardCatalog::is_better(BoardFit* a, BoardFit* b)
+{
+    if (a->model == NO_BOARD_MODEL) { return false; }
+    if (b->model == NO_BOARD_MODEL) { return true; }
+    if (a->inliers != b->inliers) { return a->inliers > b->inliers; }
+    if (a->missing != b->missing) { return a->missing < b->missing; }
+    return a->rms < b->rms;
+}
+
+
+/**
+    Correct the detected slots with the matched model. Slots that fit a fret are kept as detected, and outliers are dropped.
+    A fret without a slot is only filled in from the fit (with 0 confidence) if it lies between two detected slots, and the 
+    RMS error of the fit is below BOARD_FILL_RMS of the tolerance. Otherwise it is reported, and left out so it isn't pressed.
+    Each change is reported. Does nothing unless the last fit matched a model
+
+    @param SlotTable* slots are the slots detected on the board, which are replaced
+*/
+void BoardCatalog::correct(SlotTable* slots)
+{
+    if (!matched) { return; }
+
+    int frets = BOARD_MODELS[best.model].frets;
+    float centers[SLOT_TABLE_CAPACITY];     //corrected center of each fret
+    uint8_t confidences[SLOT_TABLE_CAPACITY];
+    bool detected[SLOT_TABLE_CAPACITY];     //whether a slot was detected for each fret
+    int first = frets + 1;                  //first and last frets with a slot detected
+    int last = 0;
+    for (int fret = 1; fret <= frets; fret++)
+    {
+        centers[fret - 1] = get_fret_position(fret);
+        confidences[fret - 1] = 0;
+        detected[fret - 1] = false;
+    }
+    for (int i = 0; i < slots->size(); i++)
+    {
+        if (best.frets[i] == 0)
+        {
+            Serial.println("Warning: slot at " + String(slots->get_center(i)) + " doesn't fit any fret, and will be ignored");
+            continue;
+        }
+        centers[best.frets[i] - 1] = slots->get_center(i);
+        confidences[best.frets[i] - 1] = slots->get_confidence(i);
+        detected[best.frets[i] - 1] = true;
+        first = min(first, (int) best.frets[i]);
+        last = max(last, (int) best.frets[i]);
+    }
+
+    bool tight = best.rms <= BOARD_FILL_RMS * BOARD_FIT_TOLERANCE * best.scale;
+    slots->clear();
+    for (int fret = 1; fret <= frets; fret++)
+    {
+        if (!detected[fret - 1])
+        {
+            if (!tight || fret < first || fret > last)
+            {
+                Serial.println("Warning: fret " + String(fret) + " wasn't detected, and won't be pressed (fitted position " + String(centers[fret - 1]) + ")");
+                continue;
+            }
+            Serial.println("Warning: fret " + String(fret) + " wasn't detected. Using the fitted position " + String(centers[fret - 1]));
+        }
+        slots->add(centers[fret - 1], confidences[fret - 1]);
+    }
+}
+
+
+/**
+    Return the board model matched by the last fit
+
+    @return const BoardModel* model is the matched model, or NULL if no model matched
+*/
+const BoardModel* BoardCatalog::get_model()
+{
+    return matched ? &BOARD_MODELS[best.model] : NULL;
+}
+
+
+/**
+    Return the fitted position of a fret on the matched model
+
+    @param int fret is the fret number (1 for the first fret)
+    @return float position is the step position of the fret
+*/
+float BoardCatalog::get_fret_position(int fret)
+{
+    return best.nut + best.scale * fret_fraction(fret);
+}
+
+
+/**
+    Return the distance from the nut to a fret, as a fraction of the scale length, i.e. 1 - 2^(-n/12)
+
+    @param int fret is the fret number
+    @return float fraction is the distance from the nut as a fraction of the scale length
+*/
+float BoardCatalog::fret_fraction(int fret)
+{
+    return 1 - pow(2.0, -fret / 12.0);
+}
+
+
+/**
+    Return a string describing the last fit: the matched model, how many frets were found, and how well they fit
+*/
+String BoardCatalog::str()
+{
+    if (min_scale == 0) { return "Board Model: NONE (the scale length range isn't set, so frets can't be identified)"; }
+    if (best.model == NO_BOARD_MODEL) { return "Board Model: NONE (no fit with a scale length of " + String(min_scale) + " to " + String(max_scale) + " steps)"; }
+    String s = "Board Model: " + String(matched ? "" : "NO MATCH (closest ") + String(BOARD_MODELS[best.model].name) + String(matched ? "" : ")") +
+               "\nFrets Detected: " + String(best.inliers) + " of " + String(BOARD_MODELS[best.model].frets) + " (" + String(best.outliers) + " outliers)" +
+               "\nScale Length: " + String(best.scale) + " steps" +
+               "\nFit Error: " + String(best.rms) + " steps RMS (tolerance " + String(BOARD_FIT_TOLERANCE * best.scale) + " steps)";
+    if (alternative != NO_BOARD_MODEL)
+    {
+        s += "\nWarning: the slots also fit a " + String(BOARD_MODELS[alternative].name) + " board with " + String(alternative_missing) + 
+             " frets undetected. Check which board it is";
+    }
+    return s;
+}
@@ -0,0 +1,134 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    BoardCatalog.h
+    Purpose: Header for the catalog of fretboard models, and fitting detected slots to them
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef BOARD_CATALOG_H
+#define BOARD_CATALOG_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include "SlotTable.h"
+
+#define NUM_BOARD_MODELS 2                  //number of boards in the catalog. Models have at most 32 frets
+#define BOARD_FIT_TOLERANCE 0.0008          //slots further than this fraction of the fitted scale length from their fret are outliers (0.5mm on a 25" scale)
+#define BOARD_FILL_RMS 0.25                 //missing frets are only filled in from the fit if its RMS error is below this fraction of the tolerance
+#define BOARD_MAX_MISSING 3                 //most frets that can be missing for a board to match
+#define BOARD_MAX_SCALE_RATIO 1.059         //widest scale length range (max/min) that still tells the frets apart. Just under a semitone, 2^(1/12)
+#define BOARD_FIT_ITERATIONS 3              //number of times slots are reassigned to frets and the fit is repeated
+#define NO_BOARD_MODEL -1                   //index of the board model when no model matched
+
+
+struct BoardModel                           //a fretboard the robot can process
+{
+    const char* name;                       //name for reports
+    uint8_t frets;                          //number of fret slots
+};
+
+
+struct BoardFit                             //result of fitting the detected slots to a board model
+{
+    int model = NO_BOARD_MODEL;             //index of the model in the catalog
+    float nut = 0;                          //fitted position (steps) of the nut
+    float scale = 0;                        //fitted scale length (steps)
+    float rms = 0;                          //RMS distance (steps) of the inliers from their fitted fret positions
+    int inliers = 0;                        //number of slots that fit a fret
+    int outliers = 0;                       //number of slots that don't fit any fret
+    int missing = 0;                        //number of frets without a slot
+    uint8_t frets[SLOT_TABLE_CAPACITY];     //fret number of each detected slot (0 for outliers)
+};
+
+
+/**
+    The BoardCatalog class identifies which fretboard is on the slide, and corrects the slots detected on it.
+    Fret n of a board with scale length L is at d = L(1 - 2^(-n/12)) from the nut, so the detected slots should fit
+    p = nut + scale * (1 - 2^(-n/12)) for every board in the catalog, and the models only differ in their number of frets.
+    
+    Moving the nut to fret k and shrinking the scale by 2^(-k/12) fits the same slots exactly, so the slots alone can't tell
+    which frets they are. The scale length (in steps) must be known to within a semitone, so it is set as a range with 
+    set_scale_range() (e.g. 24.75" to 25.5" times the slide's steps/mm, saved in EEPROM). Until it is set, no board matches.
+    
+    Every pair of neighbouring slots is tried as each pair of frets (next to each other, or with one missing between) that 
+    gives a scale in the range, so debris anywhere on the board doesn't spoil every guess. From each guess, the slots are 
+    assigned to frets, and the nut and scale are fitted by least squares. Slots far from their fitted fret are outliers 
+    (e.g. a scratch or debris), and frets without a slot are missing. A fit is rejected if its scale leaves the range, or a 
+    missing fret would be off the board (before its start, or past its end, as seen by the laser). The model with the most 
+    slots fitted wins, and any other model that fits the same slots is reported, as the board could be either.
+    correct() then drops the outliers, so frets are never pressed at a spurious slot. A missing fret is only filled in from 
+    the fit if it lies between detected slots and the fit is tight, otherwise it is reported and left out.
+
+    Example Usage:
+
+    ```
+    BoardCatalog* catalog = new BoardCatalog();
+    catalog->set_scale_range(63000, 65000); //scale length range (steps) of the boards
+    if (catalog->fit(laser->get_slots(), laser->get_board_start(), laser->get_board_end()))   //identify the board
+    {
+        catalog->correct(laser->get_slots());   //drop outliers, and fill in missing frets between detected slots
+    }
+    ```
+*/
+class BoardCatalog
+{
+public:
+    //constructor for the board catalog
+    BoardCatalog();
+
+    bool set_scale_range(long min_scale, long max_scale);   //set the range (steps) the scale length must fit within. 0 to clear it
+    long get_min_scale();                   //return the shortest scale length (steps) allowed. 0 if the range isn't set
+    long get_max_scale();                   //return the longest scale length (steps) allowed
+    bool fit(SlotTable* slots,              //fit the detected slots to every model, and keep the best fit. Return whether a model matched
+        long board_start=LONG_MIN, long board_end=LONG_MAX);
+    void correct(SlotTable* slots);         //drop the outliers, and fill in missing frets between detected slots if the fit is tight enough
+    const BoardModel* get_model();          //return the model matched by the last fit (NULL if none)
+    float get_fret_position(int fret);      //return the fitted position (steps) of a fret on the matched model
+
+    String str();                           //get a string describing the last fit
+
+private:
+    BoardFit best;                          //best fit found by the last call to fit()
+    bool matched = false;                   //whether the best fit matched its model well enough to use it
+    int alternative = NO_BOARD_MODEL;       //another model that fits the same slots as the best fit (NO_BOARD_MODEL if none)
+    int alternative_missing = 0;            //number of frets of the alternative model without a slot
+    long min_scale = 0;                     //shortest scale length (steps) a fit may have. 0 if the range isn't set
+    long max_scale = 0;                     //longest scale length (steps) a fit may have
+    long board_start = LONG_MIN;            //position (steps) of the start of the board being fitted. No missing fret can be before it
+    long board_end = LONG_MAX;              //position (steps) of the end of the board being fitted. No missing fret can be past it
+
+    void fit_model(SlotTable* slots, int model, float nut, float scale, BoardFit* result);  //fit the slots to one model from an initial guess
+    void assign_frets(SlotTable* slots, int frets, float nut, float scale, BoardFit* result);   //assign each slot to the nearest fret
+    bool least_squares(SlotTable* slots, BoardFit* result); //fit the nut and scale to the slots assigned to frets
+    bool is_better(BoardFit* a, BoardFit* b);   //return whether fit a is better than fit b
+    bool is_possible(SlotTable* slots, BoardFit* result);  //return whether a fit's scale is in range, and its missing frets are on the board
+    bool fits_fret(BoardFit* result, float position, int fret); //return whether a position is within the tolerance of a fret of a fit
+    static float fret_fraction(int fret);   //return the distance from the nut to a fret, as a fraction of the scale length
+};
+
+#endif
@@ -45,7 +45,7 @@ ButtonModule::ButtonModule(uint8_t pin, bool invert)
     this->invert = invert;
 
     //activate the sensor pin
-    pinMode(pin, INPUT_PULLUP);
+    input.begin(pin, INPUT_PULLUP);
 
     //zero the sensor buffer
     reset();
@@ -72,7 +72,7 @@ uint8_t ButtonModule::read(bool saturate)
     {
         clear_stale_buffer();                   //check if the buffer contains readings that are too old, and clear if so
     }
-    state_buffer[tail] = digitalRead(pin);      //take a measurement and store into the buffer
+    state_buffer[tail] = input.read();          //take a measurement and store into the buffer
     tail = (tail + 1) % BUFFER_LENGTH;          //increment the tail pointer and mod BUFFER_LENGTH to wrap the buffer around to the start of the array
 
     //determine the fraction of readings that are high
@@ -125,7 +125,7 @@ void ButtonModule::saturate_buffer()
 {
     for (int i = 0; i < BUFFER_LENGTH; i++)
     {
-        state_buffer[i] = digitalRead(pin);     //store the current reading
+        state_buffer[i] = input.read();         //store the current reading
     }
     timestamp = millis();                       //update timestamp so that buffer is known to be fresh
 }
@@ -34,6 +34,7 @@
 #define BUTTON_MODULE_H
 
 #include <Arduino.h>
+#include "FastGPIO.h"
 
 #define BUFFER_LENGTH 5                     //number of previous readings to check over for debouncing
 #define ACTIVATION_THRESHOLD 0.5            //fraction of readings that must be positive for the button to be pressed
@@ -72,6 +73,7 @@ public:
 
 private:
     uint8_t pin;
+    GPIOPin input;                          //input register of the pin, for reading it quickly
     bool invert;
     uint8_t state_buffer[BUFFER_LENGTH];    //buffer (queue) to store the previous states of the switch
     unsigned long tail = 0;                 //end of the buffer data structure. Should always be read as tail%BUFFER_LENGTH
@@ -0,0 +1,197 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    FastGPIO.h
+    Purpose: Fast digital IO, resolving pins to their port registers once instead of on every read/write
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef FAST_GPIO_H
+#define FAST_GPIO_H
+
+#include <Arduino.h>
+
+#define NUM_FAST_PINS 70                //number of digital pins on the Mega 2560 (0-53, and A0-A15 as 54-69)
+#define FAST_PIN_NONE 0xFF              //port index of a pin that doesn't exist
+
+//index of each IO port of the Mega 2560. Used to look up the port of a pin at compile time
+enum fast_ports {FAST_PORT_A, FAST_PORT_B, FAST_PORT_C, FAST_PORT_D, FAST_PORT_E, FAST_PORT_F, FAST_PORT_G, FAST_PORT_H, FAST_PORT_J, FAST_PORT_K, FAST_PORT_L};
+
+//port of every pin on the Mega 2560 (same mapping as the Arduino core's pins_arduino.h)
+constexpr uint8_t FAST_PIN_PORTS[NUM_FAST_PINS] =
+{
+    FAST_PORT_E, FAST_PORT_E, FAST_PORT_E, FAST_PORT_E, FAST_PORT_G, FAST_PORT_E, FAST_PORT_H, FAST_PORT_H,     //0-7
+    FAST_PORT_H, FAST_PORT_H, FAST_PORT_B, FAST_PORT_B, FAST_PORT_B, FAST_PORT_B, FAST_PORT_J, FAST_PORT_J,     //8-15
+    FAST_PORT_H, FAST_PORT_H, FAST_PORT_D, FAST_PORT_D, FAST_PORT_D, FAST_PORT_D, FAST_PORT_A, FAST_PORT_A,     //16-23
+    FAST_PORT_A, FAST_PORT_A, FAST_PORT_A, FAST_PORT_A, FAST_PORT_A, FAST_PORT_A, FAST_PORT_C, FAST_PORT_C,     //24-31
+    FAST_PORT_C, FAST_PORT_C, FAST_PORT_C, FAST_PORT_C, FAST_PORT_C, FAST_PORT_C, FAST_PORT_D, FAST_PORT_G,     //32-39
+    FAST_PORT_G, FAST_PORT_G, FAST_PORT_L, FAST_PORT_L, FAST_PORT_L, FAST_PORT_L, FAST_PORT_L, FAST_PORT_L,     //40-47
+    FAST_PORT_L, FAST_PORT_L, FAST_PORT_B, FAST_PORT_B, FAST_PORT_B, FAST_PORT_B, FAST_PORT_F, FAST_PORT_F,     //48-55
+    FAST_PORT_F, FAST_PORT_F, FAST_PORT_F, FAST_PORT_F, FAST_PORT_F, FAST_PORT_F, FAST_PORT_K, FAST_PORT_K,     //56-63
+    FAST_PORT_K, FAST_PORT_K, FAST_PORT_K, FAST_PORT_K, FAST_PORT_K, FAST_PORT_K                                //64-69
+};
+
+//bit of every pin within its port on the Mega 2560
+constexpr uint8_t FAST_PIN_BITS[NUM_FAST_PINS] =
+{
+    0, 1, 4, 5, 5, 3, 3, 4,     //0-7
+    5, 6, 4, 5, 6, 7, 1, 0,     //8-15
+    1, 0, 3, 2, 1, 0, 0, 1,     //16-23
+    2, 3, 4, 5, 6, 7, 7, 6,     //24-31
+    5, 4, 3, 2, 1, 0, 7, 2,     //32-39
+    1, 0, 7, 6, 5, 4, 3, 2,     //40-47
+    1, 0, 3, 2, 1, 0, 0, 1,     //48-55
+    2, 3, 4, 5, 6, 7, 0, 1,     //56-63
+    2, 3, 4, 5, 6, 7            //64-69
+};
+
+//registers of each port. Specialized for every port below, so that each access compiles to a fixed register address
+template <uint8_t PORT> volatile uint8_t& fast_port_output();      //PORTx register (output level, or pullup enable for inputs)
+template <uint8_t PORT> volatile uint8_t& fast_port_input();       //PINx register (input level)
+template <uint8_t PORT> volatile uint8_t& fast_port_mode();        //DDRx register (1 for output, 0 for input)
+
+#define FAST_GPIO_PORT(INDEX, LETTER) \
+    template <> inline volatile uint8_t& fast_port_output<INDEX>() { return PORT##LETTER; } \
+    template <> inline volatile uint8_t& fast_port_input<INDEX>() { return PIN##LETTER; } \
+    template <> inline volatile uint8_t& fast_port_mode<INDEX>() { return DDR##LETTER; }
+
+FAST_GPIO_PORT(FAST_PORT_A, A)
+FAST_GPIO_PORT(FAST_PORT_B, B)
+FAST_GPIO_PORT(FAST_PORT_C, C)
+FAST_GPIO_PORT(FAST_PORT_D, D)
+FAST_GPIO_PORT(FAST_PORT_E, E)
+FAST_GPIO_PORT(FAST_PORT_F, F)
+FAST_GPIO_PORT(FAST_PORT_G, G)
+FAST_GPIO_PORT(FAST_PORT_H, H)
+FAST_GPIO_PORT(FAST_PORT_J, J)
+FAST_GPIO_PORT(FAST_PORT_K, K)
+FAST_GPIO_PORT(FAST_PORT_L, L)
+
+
+/**
+    The FastPin class template is for pins whose number is a compile time constant (e.g. PIN_LASER_EMITTER).
+    The port and bit of the pin are looked up while compiling, so each read or write compiles down to a single
+    instruction on a fixed register (sbi/cbi/sbis), instead of the table lookups and checks done by digitalWrite()/digitalRead().
+    (Pins on ports H-L are outside the range of sbi/cbi, so writes to them take a few instructions with interrupts disabled)
+
+    Example Usage:
+
+    ```
+    FastPin<PIN_LASER_EMITTER>::mode(OUTPUT);
+    FastPin<PIN_LASER_EMITTER>::write(HIGH);
+    ```
+*/
+template <uint8_t PIN>
+class FastPin
+{
+    static_assert(PIN < NUM_FAST_PINS, "FastPin only supports pins 0-69 of the Mega 2560");
+    static const uint8_t PORT = FAST_PIN_PORTS[PIN];
+    static const uint8_t MASK = 1 << FAST_PIN_BITS[PIN];
+    static const bool SINGLE_INSTRUCTION = PORT <= FAST_PORT_G;    //ports A-G are in the low IO space, where writing one bit is a single (atomic) sbi/cbi
+
+public:
+    //set the pin to OUTPUT, INPUT or INPUT_PULLUP
+    static inline void mode(uint8_t mode)
+    {
+        if (mode == OUTPUT) { fast_port_mode<PORT>() |= MASK; return; }
+        fast_port_mode<PORT>() &= ~MASK;
+        if (mode == INPUT_PULLUP) { fast_port_output<PORT>() |= MASK; }
+        else { fast_port_output<PORT>() &= ~MASK; }
+    }
+
+    //set the output level of the pin to HIGH or LOW. Ports H-L need a read-modify-write, which is done with interrupts disabled
+    static inline void write(uint8_t state)
+    {
+        uint8_t status = SREG;
+        if (!SINGLE_INSTRUCTION) { cli(); }
+        if (state) { fast_port_output<PORT>() |= MASK; }
+        else { fast_port_output<PORT>() &= ~MASK; }
+        SREG = status;
+    }
+
+    //return the input level of the pin (HIGH or LOW)
+    static inline uint8_t read()
+    {
+        return (fast_port_input<PORT>() & MASK) ? HIGH : LOW;
+    }
+};
+
+
+/**
+    The GPIOPin class is for pins passed into a module at runtime (e.g. as a constructor argument).
+    The port registers and bit of the pin are looked up once when the pin is set up, so each read or write
+    afterwards is just a load or store through a cached register pointer, instead of a digitalWrite()/digitalRead().
+    Writes are done with interrupts disabled, since other pins on the same port may be written by interrupts (e.g. step pulses)
+
+    Example Usage:
+
+    ```
+    GPIOPin valve = GPIOPin(7, OUTPUT);
+    valve.write(HIGH);
+    ```
+*/
+class GPIOPin
+{
+public:
+    //constructor for a pin that isn't set up yet
+    GPIOPin() {}
+
+    //constructor for a pin in the specified mode
+    GPIOPin(uint8_t pin, uint8_t mode) { begin(pin, mode); }
+
+    //look up the registers of the pin, and set it to OUTPUT, INPUT or INPUT_PULLUP
+    void begin(uint8_t pin, uint8_t mode)
+    {
+        pinMode(pin, mode);
+        output = portOutputRegister(digitalPinToPort(pin));
+        input = portInputRegister(digitalPinToPort(pin));
+        mask = digitalPinToBitMask(pin);
+    }
+
+    //set the output level of the pin to HIGH or LOW
+    inline void write(uint8_t state)
+    {
+        uint8_t status = SREG;
+        cli();
+        if (state) { *output |= mask; }
+        else { *output &= ~mask; }
+        SREG = status;
+    }
+
+    //return the input level of the pin (HIGH or LOW)
+    inline uint8_t read()
+    {
+        return (*input & mask) ? HIGH : LOW;
+    }
+
+private:
+    volatile uint8_t* output = NULL;    //PORTx register of the pin
+    volatile uint8_t* input = NULL;     //PINx register of the pin
+    uint8_t mask = 0;                   //bit of the pin within its port
+};
+
+#endif
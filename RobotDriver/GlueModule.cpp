@@ -40,11 +40,11 @@
 GlueModule::GlueModule()
 {
     //initialize the StepperModule object for the glue motor (read-only public reference)
-    motor = new StepperModule(PIN_GLUE_PULSE, PIN_GLUE_DIRECTION, PIN_GLUE_MIN_LIMIT, PIN_GLUE_MAX_LIMIT, "glue");
+    motor = new StepperModule(PIN_GLUE_PULSE, PIN_GLUE_DIRECTION, PIN_GLUE_MIN_LIMIT, PIN_GLUE_MAX_LIMIT, GLUE_STEP_TIMER, "glue");
     
     //set motor speeds and acceleration
     motor->set_speeds(GLUE_MINIMUM_SPEED, GLUE_MEDIUM_SPEED, GLUE_MAXIMUM_SPEED);
-    motor->set_acceleration(GLUE_ACCELERATION);
+    motor->set_acceleration(GLUE_ACCELERATION, GLUE_DECELERATION);
 
     //initilize the pneumatics to control the glue stream
     glue = new PneumaticsModule(PIN_GLUE_OPEN, PIN_GLUE_CLOSE, GLUE_DEFAULT);
@@ -65,12 +65,26 @@ GlueModule::GlueModule()
 */
 int GlueModule::calibrate()
 {
-    num_errors = 0;
-    num_errors += motor->calibrate();
+    start_calibrate();
+    while (is_busy())
+    {
+        update();
+    }
     return check_errors();              //don't check for glue remaining during calibration
 }
 
 
+/**
+    Begin calibrating the glue stepper motor step position without blocking. Progressed by update()
+*/
+void GlueModule::start_calibrate()
+{
+    num_errors = -1;                    //not calibrated until the calibration completes
+    calibrating = true;
+    motor->start_calibrate();
+}
+
+
 /**
     Check if any errors occured during calibration, and the module needs to be recalibrated
 */
@@ -135,22 +149,157 @@ void GlueModule::reverse_direction()
     Glue a single slot on the fret board. currently the IR sensor is ignored, mainly due to interference from the fretboard clamp, and time constraints
 */
 void GlueModule::glue_slot()
+{
+    start_glue_slot();      //begin the glue pass
+    while (!done())         //block until the pass is complete
+    {
+        run();
+    }
+}
+
+
+/**
+    Begin a glue pass on the slot currently aligned with the needle, without blocking.
+    Every segment of the pass is queued on the motor up front, so that the needle sweeps from clear of the board, 
+    through the glue stream start and stop positions, to clear of the board on the far side in one continuous motion.
+    run() must be called each loop to progress the pass, and done() indicates when it has finished
+*/
+void GlueModule::start_glue_slot()
 {
     //interpolate for start/stop?
     // long arc_length = interpolate(0, )
-    
+
     long start = direction < 0 ? GLUE_CLEAR_POSITIVE : GLUE_CLEAR_NEGATIVE;                 //starting position of the needle, clear of the fretboard
-    long stop = direction < 0 ? GLUE_CLEAR_NEGATIVE : GLUE_CLEAR_POSITIVE;                  //ending position of the needle, clear of the fretboard
-    long glue_start = CENTER_POSITION - direction * (MIN_ARC_LENGTH + GLUE_MARGIN) / 2;   //starting position of glue stream
-    long glue_stop = CENTER_POSITION + direction * (MIN_ARC_LENGTH + GLUE_MARGIN) / 2;    //ending position of glue stream
-
-    motor->move_absolute(start, true);                                                      //move to the start position of the needle (should already be there from the last pass)
-    motor->move_absolute(glue_start, true);                                                 //move to the glue stream start position, and wait til arrived
-    glue->write(HIGH);                                                                      //activate the glue stream
-    motor->move_absolute(glue_stop, true);                                                  //move to the glue stream stop position, and wait til arrived (laying glue along the way)
-    glue->write(LOW);                                                                       //turn the glue stream off
-    motor->move_absolute(stop, true);                                                       //move clear of the slot
-    reverse_direction();                                                                    //set the next pass to move the opposite direction.
+    long glue_start = CENTER_POSITION - direction * (MIN_ARC_LENGTH + GLUE_MARGIN) / 2;    //starting position of glue stream
+    pass_stop = direction < 0 ? GLUE_CLEAR_NEGATIVE : GLUE_CLEAR_POSITIVE;                  //ending position of the needle, clear of the fretboard
+    pass_glue_stop = CENTER_POSITION + direction * (MIN_ARC_LENGTH + GLUE_MARGIN) / 2;     //ending position of glue stream
+
+    motor->move_absolute(start);                    //move to the start position of the needle (should already be there from the last pass)
+    motor->queue_absolute(start);
+    motor->queue_absolute(glue_start);              //the rest of the pass carries straight on without stopping
+    motor->queue_absolute(pass_glue_stop);
+    motor->queue_absolute(pass_stop);
+    state = GLUE_MOVE_START;
+}
+
+
+/**
+    Progress the current glue pass. THIS NEEDS TO BE CALLED ONCE PER LOOP() while a pass is in progress.
+    Each step of the pass begins as the needle passes the end of the previous segment in the motor's move queue.
+    If the pass was interrupted (e.g. by a limit switch emptying the queue), the glue stream is turned off and the pass ends
+*/
+void GlueModule::run()
+{
+    motor->run();                                   //run the glue motor (progress the move queue, and check limits)
+    if (state == GLUE_IDLE) { return; }
+
+    int remaining = motor->get_queue_length();      //segments left: glue start, glue stop, and clear on the far side
+    if (!motor->is_running() && state != GLUE_MOVE_STOP)
+    {
+        Serial.println("ERROR: glue pass was interrupted");
+        glue->write(LOW);
+        state = GLUE_MOVE_STOP;
+    }
+
+    switch (state)
+    {
+        case GLUE_MOVE_START:   //wait for the needle to be clear of the board. it carries on to the glue stream start position
+        {
+            if (remaining <= 3) { state = GLUE_MOVE_STREAM_START; }
+        }
+        break;
+
+        case GLUE_MOVE_STREAM_START:    //passing the start of the slot. activate the glue stream, and lay glue along the way to the stop position
+        {
+            if (remaining <= 2)
+            {
+                glue->write(HIGH);
+                glue_time = millis();
+                state = GLUE_STREAM;
+            }
+        }
+        break;
+
+        case GLUE_STREAM:   //passing the end of the slot. turn the glue stream off, and carry on clear of the slot
+        {
+            if (remaining <= 1)
+            {
+                glue->write(LOW);
+                state = GLUE_MOVE_STOP;
+            }
+        }
+        break;
+
+        case GLUE_MOVE_STOP:    //needle has stopped clear of the board. set the next pass to move the opposite direction
+        {
+            if (!motor->is_running())
+            {
+                reverse_direction();
+                state = GLUE_IDLE;
+            }
+        }
+        break;
+    }
+}
+
+
+/**
+    Return whether or not the current glue pass has finished
+
+    @return bool done is true if no glue pass is in progress, otherwise false
+*/
+bool GlueModule::done()
+{
+    return state == GLUE_IDLE;
+}
+
+
+/**
+    Return the time the glue stream was last turned on, i.e. when glue was laid in the most recent slot
+
+    @return unsigned long glue_time is the time in milliseconds (from millis())
+*/
+unsigned long GlueModule::get_glue_time()
+{
+    return glue_time;
+}
+
+
+/**
+    Run the glue motor, progress any glue pass, and record the result of any calibration once it completes.
+    THIS NEEDS TO BE CALLED ONCE PER LOOP()
+*/
+void GlueModule::update()
+{
+    run();
+    if (calibrating && !motor->is_calibrating())
+    {
+        calibrating = false;
+        num_errors = motor->get_calibration_result();
+    }
+}
+
+
+/**
+    Return whether or not the glue arm is moving, gluing, or calibrating
+
+    @return bool busy is true if the glue module has an action in progress, else false
+*/
+bool GlueModule::is_busy()
+{
+    return !done() || calibrating || motor->is_busy();
+}
+
+
+/**
+    Stop the glue arm, turn off the glue stream, and abandon any glue pass or calibration in progress
+*/
+void GlueModule::cancel()
+{
+    state = GLUE_IDLE;
+    calibrating = false;
+    motor->cancel();
+    glue->write(LOW);
 }
 
 
@@ -159,6 +308,7 @@ void GlueModule::glue_slot()
 */
 void GlueModule::reset()
 {
+    state = GLUE_IDLE;                                  //cancel any glue pass in progress
     motor->move_absolute(GLUE_CLEAR_POSITIVE, true);    //(blocking) move to a position clear of the fretboard and clamp
     glue->write(LOW);
     check_errors(true);                                 //check if there is adequate glue left for another job
@@ -269,6 +419,7 @@ bool GlueModule::has_glue()
 String GlueModule::str()
 {
     return "Glue Motor Position: " + String(motor->get_current_position()) +
+           "\nGlue Step Timing: " + motor->step_timing() +
            "\nGlue Stream: " + String(glue->read() == HIGH ? "ON" : "OFF") + 
            "\nGlue Weight: " + String(read_glue_weight(100)) + " grams";
 }
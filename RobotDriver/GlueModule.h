@@ -38,11 +38,14 @@
 #include "PneumaticsModule.h"
 // #include "IRModule.h"
 #include "HX711.h"
+#include "TaskEngine.h"
 
-#define GLUE_MAXIMUM_SPEED 4000                 //maximum speed of stepper motor (steps/second). Don't set this to more than 4000
+#define GLUE_MAXIMUM_SPEED 4000                 //maximum speed of stepper motor (steps/second). The glue bead is laid at this speed, so it is not raised
 #define GLUE_MEDIUM_SPEED 1000                  //nominal speed of the stepper motor
 #define GLUE_MINIMUM_SPEED 50                   //speed for moving slowly (e.g. during calibration)
-#define GLUE_ACCELERATION 100000                //acceleration of stepper motor (steps/second^2). Basically infinite, i.e. no ramp up/down.
+#define GLUE_ACCELERATION 100000                //acceleration of stepper motor (steps/second^2). Trapezoidal profile
+#define GLUE_DECELERATION 100000                //deceleration of stepper motor (steps/second^2)
+#define GLUE_STEP_TIMER STEP_TIMER_4            //hardware timer generating the step pulses for the glue motor
                         
 #define PIN_GLUE_MIN_LIMIT 37                   //pin for controlling the laser diode
 #define PIN_GLUE_MAX_LIMIT 35                   //pin for sensing the laser beam
@@ -79,18 +82,27 @@
 #define GLUE_WARNING_THRESHOLD 0.15             //percentage of capacity at which a warning is printed for low glue
 #define GLUE_ERROR_THRESHOLD 0.025              //percentage of capacity at which the robot will not operate without more glue
 
-class GlueModule
+class GlueModule : public Task
 {
 public:
     //Constructor for a GlueModule object
     GlueModule();
 
     int calibrate();                            //check the limits of the stepper motor
+    void start_calibrate();                     //begin calibrating the glue motor without blocking
     int check_errors(bool check_weight = false);//check if there are any errors. By default, only check glue weight if specified due to long delay in checking
     // void plot_sensor_response();                //plot the response of the IR sensor
     void set_direction(int direction);          //set the current direction the glue arm will make a pass
     void reverse_direction();                   //reverse the current direciton of the glue pass
-    void glue_slot();                           //perform a glue pass
+    void glue_slot();                           //perform a glue pass (blocking)
+    void start_glue_slot();                     //begin a glue pass without blocking. Call run() until done() returns true
+    void run();                                 //NEEDS TO BE CALLED ONCE PER LOOP() while a glue pass is in progress
+    bool done();                                //return whether or not the current glue pass has finished
+    unsigned long get_glue_time();              //return the time (millis) the glue stream was last turned on
+
+    void update();                              //NEEDS TO BE CALLED ONCE PER LOOP(). Run the glue motor, and progress any glue pass or calibration
+    bool is_busy();                             //return whether or not the glue arm is moving, gluing, or calibrating
+    void cancel();                              //stop the glue arm and glue stream, and abandon any glue pass or calibration
     void reset();                               //reset the glue arm for a new fret board
 
     void load_dry_weight();                     //load the saved dry weight for the glue sensor from EEPROM
@@ -115,7 +127,30 @@ private:
     // IRModule* IR_sensor;                        //for detecting the start and end of the slot
     // long previous_arc = MIN_ARC_LENGTH;         //previous arc length of the fretboard measured by the IR sensor
     int direction = 1;                          //current direction of glue arm pass. -1 for towards operator, 1 for away from operator
-    bool num_errors = -1;                       //keep track of any errors that occured during calibration
+    long pass_stop = 0;                         //position the needle ends the current pass at (clear of the slot)
+    long pass_glue_stop = 0;                    //position the glue stream is turned off at for the current pass
+    unsigned long glue_time = 0;                //time (millis) the glue stream was last turned on
+    int num_errors = -1;                        //keep track of any errors that occured during calibration. -1 until calibrated
+    bool calibrating = false;                   //whether or not a calibration is in progress
+
+    enum glue_states
+    {
+        GLUE_IDLE,                              //no glue pass in progress
+        GLUE_MOVE_START,                        //moving the needle to the clear position the pass starts from
+        GLUE_MOVE_STREAM_START,                 //moving the needle to where the glue stream turns on
+        GLUE_STREAM,                            //laying glue while moving to where the glue stream turns off
+        GLUE_MOVE_STOP                          //moving the needle clear of the slot on the far side
+
+        //Transitions occur each time the needle passes the end of a segment in the motor's move queue (without stopping):
+        //GLUE_IDLE              ->  GLUE_MOVE_START         :  when start_glue_slot() is called
+        //GLUE_MOVE_START        ->  GLUE_MOVE_STREAM_START  :  needle is clear of the board
+        //GLUE_MOVE_STREAM_START ->  GLUE_STREAM             :  glue stream is turned on
+        //GLUE_STREAM            ->  GLUE_MOVE_STOP          :  glue stream is turned off
+        //GLUE_MOVE_STOP         ->  GLUE_IDLE               :  needle has stopped clear of the board, and the pass direction is reversed
+        //any other state        ->  GLUE_MOVE_STOP          :  the motor stopped before the pass was finished (glue stream is turned off)
+    };
+
+    glue_states state = GLUE_IDLE;              //current step of the glue pass
 
     HX711* glue_weight;                         //reference to glue weight sensor
     float SCALE_DRY_WEIGHT;                     //weight of glue container + peripherals without any glue
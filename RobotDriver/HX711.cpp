@@ -47,14 +47,14 @@ void HX711::begin(byte dout, byte pd_sck, byte gain) {
   PD_SCK = pd_sck;
   DOUT = dout;
 
-  pinMode(PD_SCK, OUTPUT);
-  pinMode(DOUT, INPUT);
+  sck_pin.begin(PD_SCK, OUTPUT);
+  dout_pin.begin(DOUT, INPUT);
 
   set_gain(gain);
 }
 
 bool HX711::is_ready() {
-  return digitalRead(DOUT) == LOW;
+  return dout_pin.read() == LOW;
 }
 
 void HX711::set_gain(byte gain) {
@@ -70,7 +70,7 @@ void HX711::set_gain(byte gain) {
       break;
   }
 
-  digitalWrite(PD_SCK, LOW);
+  sck_pin.write(LOW);
   read();
 }
 
@@ -86,14 +86,16 @@ long HX711::read() {
   uint8_t filler = 0x00;
 
   // pulse the clock pin 24 times to read the data
-  data[2] = shiftIn(DOUT, PD_SCK, MSBFIRST);
-  data[1] = shiftIn(DOUT, PD_SCK, MSBFIRST);
-  data[0] = shiftIn(DOUT, PD_SCK, MSBFIRST);
+  data[2] = shift_in();
+  data[1] = shift_in();
+  data[0] = shift_in();
 
   // set the channel and the gain factor for the next reading using the clock pin
   for (unsigned int i = 0; i < GAIN; i++) {
-    digitalWrite(PD_SCK, HIGH);
-    digitalWrite(PD_SCK, LOW);
+    sck_pin.write(HIGH);
+    delayMicroseconds(1);
+    sck_pin.write(LOW);
+    delayMicroseconds(1);
   }
 
   // Replicate the most significant bit to pad out a 32-bit signed integer
@@ -151,10 +153,24 @@ long HX711::get_offset() {
 }
 
 void HX711::power_down() {
-  digitalWrite(PD_SCK, LOW);
-  digitalWrite(PD_SCK, HIGH);
+  sck_pin.write(LOW);
+  sck_pin.write(HIGH);
 }
 
 void HX711::power_up() {
-  digitalWrite(PD_SCK, LOW);
+  sck_pin.write(LOW);
+}
+
+// read one byte MSB first, pulsing the clock pin for each bit.
+// the clock is held high for 1us, since the fast pin writes are quicker than the HX711's minimum pulse width (0.2us)
+uint8_t HX711::shift_in() {
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    sck_pin.write(HIGH);
+    delayMicroseconds(1);
+    value = (value << 1) | dout_pin.read();
+    sck_pin.write(LOW);
+    delayMicroseconds(1);
+  }
+  return value;
 }
@@ -34,12 +34,15 @@
 #define HX711_H
 
 #include <Arduino.h>
+#include "FastGPIO.h"
 
 class HX711
 {
   private:
     byte PD_SCK;  // Power Down and Serial Clock Input Pin
     byte DOUT;    // Serial Data Output Pin
+    GPIOPin sck_pin;  // Serial Clock pin registers, for fast bit-banging
+    GPIOPin dout_pin; // Serial Data Output pin registers
     byte GAIN;    // amplification factor
     long OFFSET = 0;  // used for tare weight
     float SCALE = 1;  // used to return weight in grams, kg, ounces, whatever
@@ -100,6 +103,10 @@ class HX711
 
     // wakes up the chip after power down mode
     void power_up();
+
+  private:
+    // read one byte from the chip by pulsing the clock pin
+    uint8_t shift_in();
 };
 
 #endif
\ No newline at end of file
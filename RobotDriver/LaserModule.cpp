@@ -44,69 +44,278 @@ int ACTIVE_RESPONSE;      //Declare global active (i.e. laser on) response of th
 LaserModule::LaserModule(SlideModule* slide_module)
 {
     this->slide_module = slide_module;    //save the reference to the stepper object
+    sampler = new AnalogSampler(PIN_LASER_SENSOR);
     
     //define the inital values for the ambient response variables. will be redefined during calibration
     AMBIENT_RESPONSE = 40;
     ACTIVE_RESPONSE = 980;
+    reset_baselines();
 
     //setup pins to be used by laser module
-    pinMode(PIN_LASER_EMITTER, OUTPUT);
-    pinMode(PIN_LASER_SENSOR, INPUT);
+    FastPin<PIN_LASER_EMITTER>::mode(OUTPUT);
+    FastPin<PIN_LASER_SENSOR>::mode(INPUT);
 
     //laser default state is on
     write(HIGH);
 }
 
 /**
-    Calibrate the laser sensor system
+    Calibrate the laser module by comparing the sensor response with the laser off and on. Blocks until complete
 
-    @return int flag for success or failure. 0 for success, 1 for failure
-    failure may occur if the laser is misaligned, or something is obstructing its path
+    @return int num_errors is the number of errors that occured during calibration
 */
 int LaserModule::calibrate()
 {
-    Serial.println("Calibrating Laser Sensor");
+    start_calibrate();
+    while (is_busy())
+    {
+        update();
+    }
+    return check_errors();
+}
 
-    num_errors = 0;
 
-    int num_samples = 10000; //number of samples for low/high calibration
+/**
+    Begin calibrating the laser module without blocking. One sample is taken per call to update()
+*/
+void LaserModule::start_calibrate()
+{
+    Serial.println("Calibrating Laser Sensor");
+    num_errors = -1;                    //not calibrated until the calibration completes
+    sampler->stop();                    //calibration uses analogRead()
+    set_adc_prescaler(CALIBRATION_ADC_PRESCALER);
 
     //record the response with the laser off
-    write(LOW);
-    long low_response = 0;
-    for (int i = 0; i < num_samples; i++)
-    {
-        low_response += analogRead(PIN_LASER_SENSOR);
-    }
-    low_response /= num_samples;
-    Serial.println("Laser sensor LOW response: " + String(low_response));
+    start_calibration_phase(CALIBRATE_LOW);
+}
 
-    //record the response with the laser on
-    write(HIGH);
-    long high_response = 0;
-    for (int i = 0; i < num_samples; i++)
+
+/**
+    Switch the laser for a calibration phase (off for CALIBRATE_LOW, on for CALIBRATE_HIGH), and clear the running statistics.
+    The first CALIBRATION_SETTLE_SAMPLES samples are discarded while the sensor responds to the change
+
+    @param calibration_states phase is the phase to start
+*/
+void LaserModule::start_calibration_phase(calibration_states phase)
+{
+    write(phase == CALIBRATE_HIGH ? HIGH : LOW);
+    calibration_mean = 0;
+    calibration_m2 = 0;
+    calibration_count = -CALIBRATION_SETTLE_SAMPLES;
+    calibration_state = phase;
+}
+
+
+/**
+    Take the next calibration sample, and advance the calibration when the running mean and noise of the phase have converged.
+    The mean has converged once its standard error is below CALIBRATION_MEAN_TOLERANCE, and the noise once 
+    CALIBRATION_MIN_SAMPLES have been taken. A very noisy sensor stops at CALIBRATION_MAX_SAMPLES instead.
+    THIS NEEDS TO BE CALLED ONCE PER LOOP()
+*/
+void LaserModule::update()
+{
+    if (calibration_state == CALIBRATE_IDLE) return;
+
+    int sample = analogRead(PIN_LASER_SENSOR);
+    if (++calibration_count <= 0) return;       //sensor is still settling
+
+    //update the running mean and sum of squared deviations
+    float delta = sample - calibration_mean;
+    calibration_mean += delta / calibration_count;
+    calibration_m2 += delta * (sample - calibration_mean);
+
+    if (calibration_count < CALIBRATION_MIN_SAMPLES) return;
+    if (calibration_count < CALIBRATION_MAX_SAMPLES && 
+        calibration_m2 / calibration_count > CALIBRATION_MEAN_TOLERANCE * CALIBRATION_MEAN_TOLERANCE * calibration_count) return;
+
+    if (calibration_state == CALIBRATE_LOW)
     {
-        high_response += analogRead(PIN_LASER_SENSOR);
+        low_response = (long)(calibration_mean + 0.5);
+        low_noise = calibration_noise();
+        Serial.println("Laser sensor LOW response: " + String(low_response) + ", noise: " + String(low_noise) + " (" + String(calibration_count) + " samples)");
+
+        //record the response with the laser on
+        start_calibration_phase(CALIBRATE_HIGH);
+        return;
     }
-    high_response /= num_samples;
-    Serial.println("Laser sensor HIGH response: " + String(high_response));
 
-    // //turn the laser off for the end of calibration
-    // write(LOW);
+    long high_response = (long)(calibration_mean + 0.5);
+    float noise = calibration_noise();
+    Serial.println("Laser sensor HIGH response: " + String(high_response) + ", noise: " + String(noise) + " (" + String(calibration_count) + " samples)");
+    calibration_state = CALIBRATE_IDLE;
+    set_adc_prescaler(ADC_PRESCALER_BITS);
+    set_calibration(low_response, high_response, low_noise, noise);
+}
+
 
-    //confirm that laser can see the sensor (i.e. high_response was much larger than low_response)
-    if (high_response - low_response < VISIBLE_THRESHOLD) 
+/**
+    Set the ambient/active responses and their noise, and place the triggers from them, as at the end of a calibration.
+    num_errors records whether the laser can be seen and the triggers could be placed
+
+    @param int ambient is the average response with the laser off
+    @param int active is the average response with the laser on
+    @param float low_noise is the standard deviation of the response with the laser off
+    @param float high_noise is the standard deviation of the response with the laser on
+*/
+void LaserModule::set_calibration(int ambient, int active, float low_noise, float high_noise)
+{
+    this->low_noise = low_noise;
+    this->high_noise = high_noise;
+
+    //confirm that laser can see the sensor (i.e. active was much larger than ambient)
+    num_errors = 0;
+    if (active - ambient < VISIBLE_THRESHOLD) 
     {
         //failed to sense the laser properly
         num_errors += 1; 
     }
     else
     {
-        //set the nominal ambient/active response values for the laser
-        AMBIENT_RESPONSE = low_response;
-        ACTIVE_RESPONSE = high_response;
+        //set the nominal ambient/active response values for the laser, and the triggers from how noisy they are
+        AMBIENT_RESPONSE = ambient;
+        ACTIVE_RESPONSE = active;
+        if (!set_triggers(active - ambient, low_noise, high_noise))
+        {
+            num_errors += 1;
+        }
+        reset_baselines();
     }
-    return check_errors();
+}
+
+
+/**
+    Briefly turn the laser off, and set the ambient response (and the triggers) from the average reading. 
+    Takes a few milliseconds. Only done once calibrated, and never while detecting slots, as it needs analogRead()
+*/
+void LaserModule::refresh_ambient()
+{
+    if (num_errors != 0 || sampler->is_running() || is_busy()) { return; }
+
+    uint8_t previous = read();
+    write(LOW);
+    for (int i = 0; i < CALIBRATION_SETTLE_SAMPLES; i++) { analogRead(PIN_LASER_SENSOR); }  //let the sensor settle
+    long sum = 0;
+    for (int i = 0; i < AMBIENT_REFRESH_SAMPLES; i++) { sum += analogRead(PIN_LASER_SENSOR); }
+    write(previous);
+    for (int i = 0; i < CALIBRATION_SETTLE_SAMPLES; i++) { analogRead(PIN_LASER_SENSOR); }
+
+    ambient_filter = (sum << BASELINE_FILTER_SHIFT) / AMBIENT_REFRESH_SAMPLES;
+    update_baselines();
+}
+
+
+/**
+    Filter a sample into the ambient or active baseline, if the beam is known to be blocked by the board (between slots)
+    or unbroken (before the board arrives). Samples near the triggers are ignored, as they could be the edge of a slot.
+    Called from detect_slots() with the raw sample, before it is run through the state machine
+
+    @param int sample is the raw laser reading
+*/
+void LaserModule::track_baselines(int sample)
+{
+    int level = sample - AMBIENT_RESPONSE;
+    if (state == WAIT_START && level > upper_trigger)
+    {
+        active_filter += sample - (active_filter >> BASELINE_FILTER_SHIFT);
+    }
+    else if (state == SENSE_NEGATIVE && level < lower_trigger)
+    {
+        ambient_filter += sample - (ambient_filter >> BASELINE_FILTER_SHIFT);
+    }
+}
+
+
+/**
+    Move AMBIENT_RESPONSE and ACTIVE_RESPONSE to the tracked baselines, and place the triggers for the new range
+    using the noise measured during calibration. If the range has shrunk too far, the triggers are left alone
+*/
+void LaserModule::update_baselines()
+{
+    AMBIENT_RESPONSE = ambient_filter >> BASELINE_FILTER_SHIFT;
+    ACTIVE_RESPONSE = active_filter >> BASELINE_FILTER_SHIFT;
+    set_triggers(ACTIVE_RESPONSE - AMBIENT_RESPONSE, low_noise, high_noise, false);
+}
+
+
+/**
+    Restart tracking the baselines from the current AMBIENT_RESPONSE and ACTIVE_RESPONSE
+*/
+void LaserModule::reset_baselines()
+{
+    ambient_filter = (long)AMBIENT_RESPONSE << BASELINE_FILTER_SHIFT;
+    active_filter = (long)ACTIVE_RESPONSE << BASELINE_FILTER_SHIFT;
+}
+
+
+/**
+    Return the standard deviation of the samples taken in the current calibration phase
+
+    @return float noise is the standard deviation of the sensor response
+*/
+float LaserModule::calibration_noise()
+{
+    return calibration_count > 1 ? sqrt(calibration_m2 / (calibration_count - 1)) : 0;
+}
+
+
+/**
+    Set the clock prescaler of the ADC, which trades conversion time for accuracy. analogRead() doesn't change it
+
+    @param uint8_t bits are the ADPS2:0 bits, e.g. ADC_PRESCALER_BITS for the Arduino default of 128
+*/
+void LaserModule::set_adc_prescaler(uint8_t bits)
+{
+    ADCSRA = (ADCSRA & ~0x07) | (bits & 0x07);
+}
+
+
+/**
+    Set the lower and upper triggers from the calibration statistics. The lower trigger is placed TRIGGER_NOISE_SIGMAS
+    standard deviations above ambient (so noise while the board blocks the beam can't look like a slot), and the upper
+    trigger the same distance above the lower trigger (so noise can't end a slot, or start a new one, at either trigger).
+    Both gaps are at least MIN_TRIGGER_FRACTION of the range, for when the sensor is very quiet
+
+    @param long range is the difference between the active and ambient responses
+    @param float low_noise is the standard deviation of the ambient response
+    @param float high_noise is the standard deviation of the active response
+    @param (optional) bool report indicates whether the triggers (or an error) should be printed. Default true
+    @return bool success is false if the noise is too large for slots to be detected reliably (the triggers are unchanged)
+*/
+bool LaserModule::set_triggers(long range, float low_noise, float high_noise, bool report)
+{
+    float minimum_gap = MIN_TRIGGER_FRACTION * range;
+    float lower = max(TRIGGER_NOISE_SIGMAS * low_noise, minimum_gap);
+    float upper = lower + max(TRIGGER_NOISE_SIGMAS * max(low_noise, high_noise), minimum_gap);
+    if (upper > range / 2)          //slots rarely let the whole beam through, so the upper trigger needs to be well below active
+    {
+        if (report) { Serial.println("ERROR: Laser sensor is too noisy to detect slots reliably"); }
+        return false;
+    }
+    lower_trigger = (int)(lower + 0.5);
+    upper_trigger = (int)(upper + 0.5);
+    if (report) { Serial.println("Laser triggers: LOWER " + String(lower_trigger) + ", UPPER " + String(upper_trigger)); }
+    return true;
+}
+
+
+/**
+    Return whether or not a calibration is in progress
+
+    @return bool busy is true if the laser is calibrating, else false
+*/
+bool LaserModule::is_busy()
+{
+    return calibration_state != CALIBRATE_IDLE;
+}
+
+
+/**
+    Abandon any calibration in progress. The module will need to be recalibrated
+*/
+void LaserModule::cancel()
+{
+    if (calibration_state != CALIBRATE_IDLE) { set_adc_prescaler(ADC_PRESCALER_BITS); }
+    calibration_state = CALIBRATE_IDLE;
 }
 
 
@@ -136,7 +345,7 @@ int LaserModule::check_errors()
 void LaserModule::write(uint8_t state)
 {
     emitter_state = state;
-    digitalWrite(PIN_LASER_EMITTER, emitter_state);
+    FastPin<PIN_LASER_EMITTER>::write(emitter_state);
 }
 
 /**
@@ -160,25 +369,83 @@ uint8_t LaserModule::read()
 
 
 /**
-    Return the list of slot positions
+    Return the position where the current board started, i.e. where the beam was first blocked
+
+    @return long position is the slide position (steps) of the start of the board, or LONG_MIN if it hasn't been seen
+*/
+long LaserModule::get_board_start()
+{
+    return board_start;
+}
+
+
+/**
+    Return the position where the current board ended, i.e. where the beam stayed unbroken until the end of the board was detected
+
+    @return long position is the slide position (steps) of the end of the board, or LONG_MAX if it hasn't been seen
+*/
+long LaserModule::get_board_end()
+{
+    return board_end;
+}
+
+
+/**
+    Return the table of slots detected on the current board
 
-    @return long* slot_buffer is the list of locations that each fret slot was detected.
-    use get_num_slots() to get the length of this array
+    @return SlotTable* slots is the position, center and confidence of each slot, in the order they were detected
 */
-long* LaserModule::get_slot_buffer()
+SlotTable* LaserModule::get_slots()
 {
-    return slot_buffer;
+    return &slots;
 }
 
 
 /**
-    Return the number of slots detected so far (and stored in the slot_positions_buffer)
+    Return the number of slots detected so far (and stored in the slot table)
 
-    @return int num_slots is the number of stored in the slot buffer
+    @return int num_slots is the number of slots stored in the slot table
 */
 int LaserModule::get_num_slots()
 {
-    return num_slots;
+    return slots.size();
+}
+
+
+/**
+    Return the position of a detected slot
+
+    @param int index is the index of the slot (0 to get_num_slots()-1)
+    @return long position is the step position of the slot, rounded to the nearest step
+*/
+long LaserModule::get_slot_position(int index)
+{
+    return slots.get(index);
+}
+
+
+/**
+    Return the center of a detected slot, with sub-step resolution
+
+    @param int index is the index of the slot (0 to get_num_slots()-1)
+    @return float center is the step position of the center of the slot
+*/
+float LaserModule::get_slot_center(int index)
+{
+    return slots.get_center(index);
+}
+
+
+/**
+    Return how confident the detection was of the center of a slot. Low confidence means the spike was weak 
+    (e.g. the laser is misaligned, or the slot is full of debris), or there were too few samples across it (e.g. scanning too fast)
+
+    @param int index is the index of the slot (0 to get_num_slots()-1)
+    @return uint8_t confidence is from 0 (none) to 100 (full)
+*/
+uint8_t LaserModule::get_slot_confidence(int index)
+{
+    return slots.get_confidence(index);
 }
 
 
@@ -191,11 +458,25 @@ void LaserModule::plot_sensor_response()
     Serial.print(" ");
     Serial.print(0);
     Serial.print(" ");
-    Serial.println(analogRead(PIN_LASER_SENSOR));
+    Serial.println(read_response() + AMBIENT_RESPONSE);
 }
 
+
 /**
-    Run the slot detection algorithm, and store detected slots in the buffer. 
+    Return the current response of the light sensor. While the sampler is running, analogRead() would reconfigure the ADC
+    and stop its free-running conversions, so the response of the last sample taken from the sampler is returned instead
+
+    @return int response is the sensor reading minus AMBIENT_RESPONSE
+*/
+int LaserModule::read_response()
+{
+    if (sampler->is_running()) { return response; }
+    return analogRead(PIN_LASER_SENSOR) - AMBIENT_RESPONSE;
+}
+
+/**
+    Run the slot detection algorithm on every sample taken since the last call, and store detected slots in the buffer. 
+    The first call starts the sensor sampling in the background, and it stops again at the end of the board.
     THIS NEEDS TO BE CALLED ONCE PER LOOP().
 
     @param (optional) bool print indicates if the laser should print serial messages for its state. Default is false
@@ -206,18 +487,54 @@ void LaserModule::detect_slots(bool print)
 
     if (end_of_board) { return; } //only detect slots if it is not the end of the board
 
-    response = analogRead(PIN_LASER_SENSOR) - AMBIENT_RESPONSE;     //get the current laser reading
-    long index = slide_module->motor->get_current_position();       //current position of the slide motor
-  
+    if (!sampler->is_running())
+    {
+        if (capture_armed) { start_capture(); }
+        sampler->start(slide_module->motor->get_position_register());  //stamp each sample with the slide position
+    }
+
+    long index;                     //position of the slide motor when the sample was taken
+    int sample;                     //raw laser reading
+    uint8_t sequence;               //conversion number of the sample
+    while (!end_of_board && sampler->take(&index, &sample, &sequence))
+    {
+        if (capturing) { capture_sample(index, sequence, sample); }
+        track_baselines(sample);
+        response = sample - AMBIENT_RESPONSE;
+        detect_sample(index, print && !capturing);  //text would corrupt the trace
+    }
+
+    if (end_of_board)
+    {
+        sampler->stop();
+        if (capturing) { finish_capture(); }
+        if (print && sampler->get_dropped() > 0)
+        {
+            Serial.println("Warning: " + String(sampler->get_dropped()) + " laser samples were dropped. The main loop fell behind the sensor");
+        }
+    }
+}
+
+
+/**
+    Run the slot detection state machine on a single laser reading (stored in response)
+
+    @param long index is the position of the slide motor when the reading was taken
+    @param bool print indicates if the laser should print serial messages for its state
+*/
+void LaserModule::detect_sample(long index, bool print)
+{
     switch (state)
     {
         case WAIT_START:    //currently don't sense the fret board. wait till it starts to pass in front of the sensor
         {
-            if (response < LOWER_TRIGGER)   //see the start of the fret board. begin searching for slots and/or the end of the fret board)
+            if (response < lower_trigger)   //see the start of the fret board. begin searching for slots and/or the end of the fret board)
             {
                 if (print) { Serial.println("Detected start of fret board"); }
+                update_baselines();                 //the active baseline has been tracked up until the board arrived
                 state = SENSE_NEGATIVE;
                 trigger_index = index;
+                board_start = index;
             }
         }
         break;
@@ -225,15 +542,18 @@ void LaserModule::detect_slots(bool print)
 
         case SENSE_NEGATIVE:  //sensing the fret board. wait until a slot starts to appear
         {
-            if (response > UPPER_TRIGGER) //see a possible slot. initializing search for center of fret
+            if (response > upper_trigger) //see a possible slot. initializing search for center of fret
             {
                 //if (this->print) { Serial.println("Detected slot or end of board."); }
                 state = SENSE_POSITIVE;
                 trigger_index = index;
 
-                //zero the parameters used to find a peak
+                //zero the parameters used to find a peak, and its centroid
                 peak_response = 0;
                 peak_index = 0;
+                centroid_weight = response - upper_trigger; //this sample is at trigger_index, so it adds no moment
+                centroid_moment = 0;
+                centroid_samples = 1;
             }
         }
         break;
@@ -246,24 +566,43 @@ void LaserModule::detect_slots(bool print)
                 peak_response = response;
                 peak_index = index;  
             }
+            if (response > upper_trigger)   //accumulate the centroid of the spike. Only samples above upper_trigger count, as on the rising edge
+            {
+                centroid_weight += response - upper_trigger;
+                centroid_moment += (response - upper_trigger) * (index - trigger_index);
+                centroid_samples++;
+            }
 
-            if (response < LOWER_TRIGGER)   //check to see if we detect the end of the fret slot, or the end of the board
+            if (response < lower_trigger)   //check to see if we detect the end of the fret slot, or the end of the board
             {
-                //detected a fret
+                //detected a fret. Its center is the centroid of the spike
+                float center = trigger_index + (float)centroid_moment / centroid_weight;
+                float height = min(1.0, (float)peak_response / (ACTIVE_RESPONSE - AMBIENT_RESPONSE));
+                float width = min(1.0, (float)centroid_samples / CONFIDENT_SLOT_SAMPLES);
+                uint8_t confidence = (uint8_t)(100 * height * width + 0.5);
                 if (print) //print a message saying we found a fret at a position 
                 { 
-                    Serial.println("Found slot at index: " + String(peak_index) + ", with response: " + String(peak_response)); 
+                    Serial.println("Found slot at index: " + String(center) + ", with response: " + String(peak_response) + ", confidence: " + String(confidence)); 
                 }
+                //the end of the board has to be longer than any slot, so scale it from the widest one
+                widest_slot = max(widest_slot, index - trigger_index);
+                end_of_board_distance = constrain(END_OF_BOARD_WIDTHS * widest_slot, END_OF_BOARD_MIN_DISTANCE, END_OF_BOARD_DISTANCE);
+
+                update_baselines();                 //follow any ambient drift tracked since the last slot
                 state = SENSE_NEGATIVE;
                 trigger_index = index;
-                slot_buffer[num_slots++] = index;   //save the step position into the slot_position_buffer
+                if (!slots.add(center, confidence) && print)  //save the slot into the slot table
+                {
+                    Serial.println("ERROR: slot at index " + String(center) + " couldn't be stored in the slot table (" + String(slots.size()) + " slots stored)");
+                }
             }
-            else if (index - trigger_index > 500)   //if trigger index is significantly different from the current index, then the fretboard has completely passed the sensor. This number should be larger than any single slot could be in step size
+            else if (index - trigger_index > end_of_board_distance) //if trigger index is significantly different from the current index, then the fretboard has completely passed the sensor. This is larger than any slot detected so far
             {
                 //detected the end of the board
                 if (print) { Serial.println("Detected end of the fret board."); }
                 // else Serial.println(ACTIVE_RESPONSE);   //plot a spike in the plotter to detect this
                 state = WAIT_START;
+                board_end = trigger_index;  //the beam has been unbroken since the last trigger
                 trigger_index = index;
                 end_of_board = true;    //stop detecting new slots in the fretboard
             }
@@ -273,6 +612,101 @@ void LaserModule::detect_slots(bool print)
 }
 
 
+/**
+    Arm (or disarm) a capture of the next detection pass. The serial connection switches to CAPTURE_BAUD until the capture 
+    is finished (at the end of the board, or reset()), and every raw sample is streamed as a binary trace for LaserReplay 
+    in place of the usual detection messages
+
+    @param (optional) bool armed is true to capture the next detection pass, or false to cancel. Default true
+*/
+void LaserModule::capture(bool armed)
+{
+    if (armed == capture_armed || capturing) { return; }
+    capture_armed = armed;
+    Serial.println(armed ? "Laser capture armed. Switching to " + String(CAPTURE_BAUD) + " baud" : "Laser capture disarmed. Switching to " + String(SERIAL_BAUD) + " baud");
+    Serial.flush();
+    Serial.begin(armed ? CAPTURE_BAUD : SERIAL_BAUD);
+}
+
+
+/**
+    Stream the header of a trace: the magic "LTRC", the format version, the sample period, and the calibration that 
+    detection starts from (ambient/active responses, triggers, and noise)
+*/
+void LaserModule::start_capture()
+{
+    capture_armed = false;
+    capturing = true;
+    capture_first = true;
+
+    uint8_t version = CAPTURE_VERSION;
+    uint16_t period = ADC_SAMPLE_PERIOD;
+    int16_t calibration[4] = { (int16_t)AMBIENT_RESPONSE, (int16_t)ACTIVE_RESPONSE, (int16_t)lower_trigger, (int16_t)upper_trigger };
+    write_capture("LTRC", 4);
+    write_capture(&version, sizeof(version));
+    write_capture(&period, sizeof(period));
+    write_capture(calibration, sizeof(calibration));
+    write_capture(&low_noise, sizeof(low_noise));
+    write_capture(&high_noise, sizeof(high_noise));
+}
+
+
+/**
+    Stream a sample record: the change in position and sequence number since the last sample, and the raw reading.
+    The first sample, or one that moved too far to fit the delta, is preceded by a CAPTURE_ABSOLUTE record instead
+
+    @param long index is the position of the slide motor when the sample was taken
+    @param uint8_t sequence is the conversion number of the sample
+    @param int sample is the raw laser reading
+*/
+void LaserModule::capture_sample(long index, uint8_t sequence, int sample)
+{
+    long delta = index - capture_position;
+    if (capture_first || delta <= -CAPTURE_ESCAPE || delta >= CAPTURE_ESCAPE)
+    {
+        uint8_t escape[2] = { CAPTURE_ESCAPE, CAPTURE_ABSOLUTE };
+        int32_t position = index;
+        write_capture(escape, sizeof(escape));
+        write_capture(&position, sizeof(position));
+        delta = 0;
+        if (capture_first) { capture_sequence = sequence - 1; }  //the first sample is one after the (unstreamed) one before it
+        capture_first = false;
+    }
+    uint8_t record[4] = { (uint8_t)(int8_t)delta, (uint8_t)(sequence - capture_sequence), (uint8_t)sample, (uint8_t)(sample >> 8) };
+    write_capture(record, sizeof(record));
+    capture_position = index;
+    capture_sequence = sequence;
+}
+
+
+/**
+    Stream the end of the trace, with the number of samples the sampler dropped, and return to SERIAL_BAUD
+*/
+void LaserModule::finish_capture()
+{
+    uint8_t escape[2] = { CAPTURE_ESCAPE, CAPTURE_END };
+    uint16_t dropped = sampler->get_dropped();
+    write_capture(escape, sizeof(escape));
+    write_capture(&dropped, sizeof(dropped));
+    Serial.flush();
+    Serial.begin(SERIAL_BAUD);
+    capturing = false;
+    Serial.println("Laser capture finished");
+}
+
+
+/**
+    Stream raw bytes of the trace. Multi-byte values are little endian, as on the AVR
+
+    @param const void* data is the bytes to stream
+    @param uint8_t length is the number of bytes
+*/
+void LaserModule::write_capture(const void* data, uint8_t length)
+{
+    Serial.write((const uint8_t*)data, length);
+}
+
+
 /**
     Return whether or not the entire board has been detected
 
@@ -288,8 +722,14 @@ bool LaserModule::done()
 */
 void LaserModule::reset()
 {
-    num_slots = 0;          //to clear the buffer, simply set number of slots to 0
+    sampler->stop();        //in case detection was abandoned part way through the board
+    if (capturing) { finish_capture(); }
+    slots.clear();          //clear the slots from the previous board
     end_of_board = false;   //for a new board, we have not yet seen the end
+    widest_slot = 0;        //the new board's slots may be a different width
+    board_start = LONG_MIN; //the new board's edges haven't been seen yet
+    board_end = LONG_MAX;
+    end_of_board_distance = END_OF_BOARD_DISTANCE;
     state = WAIT_START;     //inital state the sensor is for sensing a new board
     
     // //if no error, turn of laser, else leave on
@@ -302,6 +742,8 @@ void LaserModule::reset()
     //     write(HIGH);
     // }
     write(HIGH); //leave the laser on
+    if (REFRESH_AMBIENT_ON_RESET) { refresh_ambient(); }
+    reset_baselines();
 }
 
 
@@ -310,5 +752,6 @@ void LaserModule::reset()
 */
 String LaserModule::str()
 {
-    return "Laser Emitter is " + String(read() == HIGH ? "ON" : "OFF") + "\nLaser Sensor reads: " + String(analogRead(PIN_LASER_SENSOR) - AMBIENT_RESPONSE);
+    return "Laser Emitter is " + String(read() == HIGH ? "ON" : "OFF") + "\nLaser Sensor reads: " + String(read_response()) +
+           "\nTriggers: LOWER " + String(lower_trigger) + ", UPPER " + String(upper_trigger) + ", END OF BOARD " + String(end_of_board_distance) + " steps";
 }
\ No newline at end of file
@@ -34,16 +34,41 @@
 #define LASER_MODULE_H
 
 #include <Arduino.h>
+#include <limits.h>
 #include "SlideModule.h"
+#include "TaskEngine.h"
+#include "FastGPIO.h"
+#include "AnalogSampler.h"
+#include "SlotTable.h"
 
 #define PIN_LASER_EMITTER 53        //pin for controlling the laser diode
 #define PIN_LASER_SENSOR A15        //pin for sensing the laser beam
 
-#define MAX_SLOTS 256               //god help you if this isn't big enough
-#define UPPER_TRIGGER 200           //signal must be at least this high to trigger the SENSE_POSITIVE state
-#define LOWER_TRIGGER 100           //signal must be at least this low to trigger SENSE_NEGATIVE or WAIT_START
-
+#define UPPER_TRIGGER 200           //default upper trigger. Signal must be at least this high to trigger the SENSE_POSITIVE state
+#define LOWER_TRIGGER 100           //default lower trigger. Signal must be at least this low to trigger SENSE_NEGATIVE or WAIT_START
+#define TRIGGER_NOISE_SIGMAS 6      //calibrated triggers are at least this many standard deviations of sensor noise apart (and above ambient)
+#define MIN_TRIGGER_FRACTION 0.1    //calibrated triggers are at least this fraction of the ambient/active range apart (and above ambient)
+#define END_OF_BOARD_DISTANCE 500   //default (and largest) distance (steps) the beam must stay unbroken for the end of the board. Larger than any slot
+#define END_OF_BOARD_MIN_DISTANCE 150   //smallest distance (steps) the beam must stay unbroken for the end of the board
+#define END_OF_BOARD_WIDTHS 4       //the beam must stay unbroken for this many times the widest slot seen so far for the end of the board
+#define BASELINE_FILTER_SHIFT 6     //ambient/active baselines move 1/2^BASELINE_FILTER_SHIFT (1/64) of the way to each off-board/blocked sample
+#define REFRESH_AMBIENT_ON_RESET true   //whether reset() briefly turns the laser off to measure the ambient response directly
+#define AMBIENT_REFRESH_SAMPLES 64  //number of samples averaged when the ambient response is refreshed with the laser off
+#define CONFIDENT_SLOT_SAMPLES 4    //number of samples above the upper trigger needed across a slot for full confidence in its center
+#define LOW_SLOT_CONFIDENCE 50      //slots detected with less confidence (0-100) than this are reported after detection
+
+#define CALIBRATION_MAX_SAMPLES 10000   //most samples taken for each of the low/high calibration readings, if the statistics never converge
+#define CALIBRATION_MIN_SAMPLES 200 //fewest samples for each reading. Enough for the standard deviation to be within ~10%
+#define CALIBRATION_SETTLE_SAMPLES 32   //samples discarded after switching the laser, while the sensor settles
+#define CALIBRATION_MEAN_TOLERANCE 0.25 //a reading is finished once the standard error of its mean is below this (ADC counts)
+#define CALIBRATION_ADC_PRESCALER 0x05  //ADPS2:0 bits used while calibrating. 16MHz/32 gives 26us conversions (vs 104us), at a slight loss of accuracy
 #define VISIBLE_THRESHOLD 800       //required minimum difference between ambient/active response to sense the laser
+#define SERIAL_BAUD 115200          //baud rate of the serial connection
+#define CAPTURE_BAUD 1000000        //baud rate while a laser trace capture is armed. 4 bytes every ADC_SAMPLE_PERIOD needs at least ~400000
+#define CAPTURE_VERSION 1           //version of the laser trace format (see LaserReplay/README.md)
+#define CAPTURE_ESCAPE 0x80         //position delta that marks a special record in a laser trace, instead of a sample
+#define CAPTURE_ABSOLUTE 'A'        //escaped record with the absolute position of a sample (the first sample, or when the delta doesn't fit)
+#define CAPTURE_END 'E'             //escaped record ending a laser trace
 extern int AMBIENT_RESPONSE;        //default ambient response of the sensor (i.e. laser turned OFF). Can be set via calibration
 extern int ACTIVE_RESPONSE;         //default active response of the sensor (i.e. laser turned ON). Can be set via calibration
 
@@ -55,7 +80,25 @@ extern int ACTIVE_RESPONSE;         //default active response of the sensor (i.e
     When the Fretboard passes in front of the laser, the beam is broken.
     When a slot passes in front of the laser, the beam is momentarily reconnected.
     The sensor looks for such momentary spikes in output voltage which indicate a slot has been spotted
-    This is then paired with the current step position of the slide stepper motor to locate the fret
+    This is then paired with the current step position of the slide stepper motor to locate the fret.
+    Calibration measures the mean and noise of the sensor with the laser off and on, and places the lower/upper triggers 
+    TRIGGER_NOISE_SIGMAS standard deviations clear of the noise, so that noise can't start or end a slot. 
+    Shop lighting drifts, so the baselines are tracked during every scan: the active response from the unbroken beam before 
+    the board arrives, and the ambient response while the board blocks the beam between slots. The triggers follow them 
+    at the start of the board, and after every slot. reset() also refreshes the ambient response with the laser briefly off.
+    The end of the board
+    is detected once the beam stays unbroken for END_OF_BOARD_WIDTHS times the widest slot seen so far.
+    The center of each slot is the centroid of every sample in the spike (weighted by how far it is above the upper trigger), 
+    so it has sub-step resolution, and isn't biased by the scan direction or speed like the edges of the spike are.
+    Each slot also gets a confidence (0-100) from the height of the spike and the number of samples across it
+
+    While detecting, the sensor is sampled continuously by the ADC interrupt (see AnalogSampler), and each sample is 
+    stamped with the slide position at the moment it was taken. detect_slots() then works through the buffered samples,
+    so the slide can scan at full speed without the main loop having to keep up with every reading
+
+    For offline tuning, capture() streams every raw sample of the next detection pass over serial in a compact binary 
+    trace (calibration, then position/sequence/reading per sample), which LaserReplay runs back through detect_slots() 
+    on a PC. The format is documented in LaserReplay/README.md
 
     Example Usage:
     
@@ -72,29 +115,42 @@ extern int ACTIVE_RESPONSE;         //default active response of the sensor (i.e
     loop()
     {
         laser->detect_slots()               //needs to be called once per loop to run the laser sensor
-                                            //slots detected are stored in laser.get_slot_positions();
+                                            //slots detected are stored in laser.get_slots();
                                             //number of slots found is stored in laser.get_num_slots();
     }
     ```
 */
-class LaserModule
+class LaserModule : public Task
 {
 public:
     //constructor for the Laser Fret Detector system. Requires reference to the slide stepper motor object
     LaserModule(SlideModule* slide_module);
 
     int calibrate();                        //calibrate the laser module. return status of calibration
+    void start_calibrate();                 //begin calibrating the laser module without blocking. Progressed by update()
     int check_errors();                     //check how many errors occured during calibration
     void write(uint8_t state);              //turn the laser on or off
     void toggle();                          //toggle the current state of the laser emitter
     uint8_t read();                         //get the current state of the laser emitter
-    long* get_slot_buffer();                //return a pointer to the array of detected slots 
-    int get_num_slots();                    //return the number of slots detected (i.e. length of get_slot_positions() array)
+    SlotTable* get_slots();                 //return the table of detected slots
+    int get_num_slots();                    //return the number of slots detected
+    long get_slot_position(int index);      //return the position of the specified slot (rounded to the nearest step)
+    float get_slot_center(int index);       //return the center of the specified slot, with sub-step resolution
+    uint8_t get_slot_confidence(int index); //return the confidence (0-100) in the center of the specified slot
+    long get_board_start();                 //return the position where the board started to block the beam (LONG_MIN if not seen yet)
+    long get_board_end();                   //return the position where the board stopped blocking the beam (LONG_MAX if not seen yet)
     void plot_sensor_response();            //plot the current response of the laser signal (for serial plotter)
     void detect_slots(bool print=false);    //NEEDS TO BE CALLED ONCE PER LOOP(). Search for slots using the laser sensor
     bool done();                            //return whether or not the whole board has been detected
     void reset();                           //reset the slots detected by the sensor
 
+    void refresh_ambient();                 //briefly turn the laser off, and measure the ambient response directly
+    void set_calibration(int ambient, int active, float low_noise, float high_noise);  //set the calibration directly, e.g. from a recorded trace
+    void capture(bool armed=true);          //arm (or disarm) streaming a binary trace of the raw samples of the next detection pass
+    void update();                          //NEEDS TO BE CALLED ONCE PER LOOP(). Take the next calibration sample, if calibrating
+    bool is_busy();                         //return whether or not a calibration is in progress
+    void cancel();                          //abandon any calibration in progress
+
     String str();                           //get a string describing the current state of the laser module
     String repr();                          //get a string with the underlying representation of the laser module
 
@@ -104,12 +160,24 @@ private:
     int peak_response = 0;                  //for finding the maximum/peak in a sequence of sensor readings
     long peak_index = 0;                    //index at which a peak was detected
     long trigger_index = 0;                 //index that the most recent trigger was activated
+    int upper_trigger = UPPER_TRIGGER;      //signal must be at least this high to start a slot. Set by calibration
+    int lower_trigger = LOWER_TRIGGER;      //signal must be at least this low to end a slot, or start the board. Set by calibration
+    long widest_slot = 0;                   //widest slot (steps) detected on the current board
+    long board_start = LONG_MIN;            //position the current board started to block the beam. LONG_MIN until seen
+    long board_end = LONG_MAX;              //position the current board stopped blocking the beam. LONG_MAX until seen
+    long end_of_board_distance = END_OF_BOARD_DISTANCE; //distance (steps) the beam must stay unbroken for the end of the board
+    long centroid_weight = 0;               //sum of the weights (response above upper_trigger) of the samples in the current spike
+    long centroid_moment = 0;               //sum of the weights times the distance of each sample from trigger_index
+    int centroid_samples = 0;               //number of samples above upper_trigger in the current spike
     SlideModule* slide_module;              //reference to the slide stepper motor, used to get current step positions
+    AnalogSampler* sampler;                 //free-running ADC sampler for the sensor, stamping samples with the slide position
 
-    int num_slots = 0;                      //current count for number of slots detected by the sensor
-    long slot_buffer[MAX_SLOTS];            //buffer holding the step position of each slot in memory
+    SlotTable slots;                        //position, center and confidence of each slot detected on the current board
     bool end_of_board = false;              //change to true, when the entire board has passed the laser
 
+    void detect_sample(long index, bool print); //run the slot detection state machine on one sample (in response) taken at slide position index
+    int read_response();                    //return the current response of the sensor, without disturbing the sampler if it is running
+
     enum laser_states
     {
         WAIT_START,                         //before the robot sees the fretboard, it waits for start
@@ -118,14 +186,56 @@ private:
 
         //Transitions are as follows:
         //NULL            ->  WAIT_START      :  on startup
-        //WAIT_START      ->  SENSE_NEGATIVE  :  when LOWER_TRIGGER is crossed
-        //SENSE_NEGATIVE  ->  SENSE_POSITIVE  :  when UPPER TRIGGER is crossed. During this period (SENSE_POSITIVE), search for a peak (might transition to wait_start)
-        //SENSE_POSITIVE  ->  SENSE_NEGATIVE  :  when LOWER_TRIGGER is crossed. This transition is the detection of a fret slot.
-        //SENSE_POSITIVE  ->  WAIT_START      :  when index - trigger_index > value_larger_than_slot_thickness
+        //WAIT_START      ->  SENSE_NEGATIVE  :  when lower_trigger is crossed
+        //SENSE_NEGATIVE  ->  SENSE_POSITIVE  :  when upper_trigger is crossed. During this period (SENSE_POSITIVE), search for a peak (might transition to wait_start)
+        //SENSE_POSITIVE  ->  SENSE_NEGATIVE  :  when lower_trigger is crossed. This transition is the detection of a fret slot.
+        //SENSE_POSITIVE  ->  WAIT_START      :  when index - trigger_index > end_of_board_distance
     };
 
     laser_states state = WAIT_START;        //initialize the laser sensor as waiting to see the fret board.
 
+    enum calibration_states
+    {
+        CALIBRATE_IDLE,                     //no calibration in progress
+        CALIBRATE_LOW,                      //sampling the sensor response with the laser off
+        CALIBRATE_HIGH                      //sampling the sensor response with the laser on
+
+        //Transitions are as follows:
+        //NULL            ->  CALIBRATE_IDLE  :  on startup
+        //CALIBRATE_IDLE  ->  CALIBRATE_LOW   :  when start_calibrate() is called
+        //CALIBRATE_LOW   ->  CALIBRATE_HIGH  :  when the mean and noise have converged (or CALIBRATION_MAX_SAMPLES have been taken)
+        //CALIBRATE_HIGH  ->  CALIBRATE_IDLE  :  when the mean and noise have converged (or CALIBRATION_MAX_SAMPLES have been taken). The result is recorded in num_errors
+        //any             ->  CALIBRATE_IDLE  :  when cancel() is called
+    };
+
+    calibration_states calibration_state = CALIBRATE_IDLE;
+    float calibration_mean = 0;             //running mean of the samples in the current calibration phase (Welford's method)
+    float calibration_m2 = 0;               //running sum of squared deviations from the mean in the current calibration phase
+    int calibration_count = 0;              //number of samples taken in the current calibration phase. Negative while the sensor settles
+    long low_response = 0;                  //average response measured with the laser off
+    float low_noise = 0;                    //standard deviation of the response measured with the laser off
+    float high_noise = 0;                   //standard deviation of the response measured with the laser on
+    long ambient_filter = 0;                //tracked ambient response, scaled up by 2^BASELINE_FILTER_SHIFT
+    long active_filter = 0;                 //tracked active response, scaled up by 2^BASELINE_FILTER_SHIFT
+
+    float calibration_noise();              //return the standard deviation of the samples in the current calibration phase
+    void start_calibration_phase(calibration_states phase); //switch the laser for the phase, and clear the running statistics
+    void set_adc_prescaler(uint8_t bits);   //set the ADC clock prescaler bits (ADPS2:0)
+    bool set_triggers(long range, float low_noise, float high_noise, bool report=true);   //set the triggers from the calibration statistics. Return false if too noisy
+    void track_baselines(int sample);       //filter an off-board or blocked sample into the ambient/active baselines
+    void update_baselines();                //move AMBIENT_RESPONSE/ACTIVE_RESPONSE (and the triggers) to the tracked baselines
+    void reset_baselines();                 //restart tracking from AMBIENT_RESPONSE/ACTIVE_RESPONSE
+
+    bool capture_armed = false;             //whether the next detection pass will be captured
+    bool capturing = false;                 //whether samples are currently being streamed
+    long capture_position = 0;              //position of the last sample streamed. Only valid after the first sample
+    bool capture_first = false;             //whether the next sample streamed is the first of the trace
+    uint8_t capture_sequence = 0;           //sequence number of the last sample streamed
+    void start_capture();                   //stream the trace header, at the start of a captured detection pass
+    void capture_sample(long index, uint8_t sequence, int sample);  //stream a single sample record
+    void finish_capture();                  //stream the end of the trace, and return to SERIAL_BAUD
+    void write_capture(const void* data, uint8_t length);   //stream raw bytes of the trace
+
     int num_errors = -1;                         //keep track of any errors that occurred during calibration
 };
 
@@ -0,0 +1,219 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    MotionCoordinator.cpp
+    Purpose: Coordinate moves of several stepper motors, so that they start and finish together
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "MotionCoordinator.h"
+#include <util/atomic.h>
+
+
+/**
+    Constructor for the motion coordinator. Attaches to Timer1, and doesn't drive any pins itself
+*/
+MotionCoordinator::MotionCoordinator() : StepGenerator(COORDINATOR_TIMER, NO_STEP_PIN, NO_STEP_PIN)
+{
+}
+
+
+/**
+    Add an axis to the next coordinated move. Nothing moves until start() is called
+
+    @param StepGenerator* axis is the step generator of the axis to move
+    @param long target is the absolute step position to move the axis to
+    @return bool success is true if the axis was added, or false if the move already has MAX_COORDINATED_AXES axes
+*/
+bool MotionCoordinator::add(StepGenerator* axis, long target)
+{
+    if (num_pending >= MAX_COORDINATED_AXES)
+    {
+        Serial.println("ERROR: MotionCoordinator can only move " + String(MAX_COORDINATED_AXES) + " axes together");
+        return false;
+    }
+    pending[num_pending] = axis;
+    pending_targets[num_pending] = target;
+    num_pending++;
+    return true;
+}
+
+
+/**
+    Start moving every added axis together. The dominant axis (the furthest to go) sets the number of coordinator steps,
+    the most limited axis sets the shape of the ramp, and the slowest axis (scaled by its share of the steps) sets the speed.
+    The coordinator steps in the background, and is_running() is true until every axis has arrived
+*/
+void MotionCoordinator::start()
+{
+    if (is_running())
+    {
+        Serial.println("ERROR: MotionCoordinator can't start a move while the last one is in progress");
+        clear();
+        return;
+    }
+
+    //if an axis is already moving on its own, it can't be taken over mid move, so just send every axis to its target
+    for (int i = 0; i < num_pending; i++)
+    {
+        if (pending[i]->is_running())
+        {
+            for (int j = 0; j < num_pending; j++) { pending[j]->move_to(pending_targets[j]); }
+            clear();
+            return;
+        }
+    }
+
+    //find the number of steps for each axis, and the dominant axis
+    num_axes = num_pending;
+    total = 0;
+    for (int i = 0; i < num_axes; i++)
+    {
+        axes[i] = pending[i];
+        targets[i] = pending_targets[i];
+        steps[i] = (uint32_t) abs(targets[i] - axes[i]->get_position());
+        total = max(total, steps[i]);
+    }
+    clear();
+    if (total == 0) { return; }
+
+    //find the most limited ramp (lowest acceleration once scaled up to the dominant axis), and the fastest speed every axis can keep up with
+    int limiting = -1;
+    float limiting_acceleration = 0;
+    float speed_limit = 0;
+    for (int i = 0; i < num_axes; i++)
+    {
+        if (steps[i] == 0) { continue; }
+        float ratio = (float) total / steps[i];
+        float axis_speed = axes[i]->get_speed() * ratio;
+        float axis_acceleration = axes[i]->acceleration * ratio;       //0 if the axis has no ramp (starts at full speed)
+        if (limiting < 0 || axis_speed < speed_limit) { speed_limit = axis_speed; }
+        if (limiting < 0 || (axis_acceleration > 0 && (limiting_acceleration == 0 || axis_acceleration < limiting_acceleration)))
+        {
+            limiting = i;
+            limiting_acceleration = axis_acceleration;
+        }
+    }
+    set_speed(speed_limit);
+    scale_ramp(axes[limiting], (float) total / steps[limiting]);
+
+    //hand every axis over to the coordinator, and start stepping
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (int i = 0; i < num_axes; i++)
+        {
+            errors[i] = total / 2;
+            if (steps[i] == 0) { continue; }
+            axes[i]->target = targets[i];
+            axes[i]->write_direction(targets[i] > axes[i]->position ? 1 : -1);
+            axes[i]->running = true;
+            axes[i]->coordinated = true;
+        }
+        set_position(0);
+        move_to(total);
+    }
+}
+
+
+/**
+    Immediately stop the coordinated move in progress, and every axis in it
+*/
+void MotionCoordinator::stop()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        StepGenerator::stop();
+        for (int i = 0; i < num_axes; i++)
+        {
+            if (axes[i]->coordinated) { axes[i]->stop(); }
+        }
+        num_axes = 0;
+    }
+}
+
+
+/**
+    Remove every axis added to the next coordinated move, without moving anything
+*/
+void MotionCoordinator::clear()
+{
+    num_pending = 0;
+}
+
+
+/**
+    Step every axis whose Bresenham error term has overflowed, so that each axis moves in proportion to the dominant axis.
+    All step pins are raised together here, and lowered together by end_pulse() after the rest of the step.
+    If any axis was stopped during the move (e.g. by cancel), or its limit switch trips, the whole move is stopped instead.
+    RUNS IN THE TIMER INTERRUPT
+*/
+void MotionCoordinator::begin_pulse()
+{
+    stepped = 0;
+    for (int i = 0; i < num_axes; i++)
+    {
+        StepGenerator* axis = axes[i];
+        if (axis->position == targets[i]) { continue; } //axis already arrived
+        if (!axis->coordinated || axis->check_limit())  //axis was stopped part way (or just hit a limit switch)
+        {
+            stop();
+            return;
+        }
+
+        errors[i] += steps[i];
+        if (errors[i] >= total)
+        {
+            errors[i] -= total;
+            *axis->pulse_port |= axis->pulse_mask;      //begin the step pulse
+            axis->position += axis->direction;
+            stepped |= 1 << i;
+        }
+    }
+}
+
+
+/**
+    Lower the step pins raised by begin_pulse(), and hand each axis that arrived back to its own timer.
+    Called once the step has updated its ramp, so the pulse spans that work instead of a busy wait.
+    RUNS IN THE TIMER INTERRUPT
+*/
+void MotionCoordinator::end_pulse()
+{
+    for (int i = 0; i < MAX_COORDINATED_AXES; i++)     //not num_axes, which is cleared if begin_pulse() aborted the move with pins raised
+    {
+        if (!(stepped & (1 << i))) { continue; }
+        StepGenerator* axis = axes[i];
+        *axis->pulse_port &= ~axis->pulse_mask;         //end the step pulse
+        if (axis->position == targets[i])               //axis arrived. Hand it back
+        {
+            axis->running = false;
+            axis->coordinated = false;
+        }
+    }
+
+    if (!is_running()) { num_axes = 0; }                //that was the final step of the coordinated move
+}
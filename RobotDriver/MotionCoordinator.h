@@ -0,0 +1,100 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    MotionCoordinator.h
+    Purpose: Header for coordinating moves of several stepper motors, so that they start and finish together
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef MOTION_COORDINATOR_H
+#define MOTION_COORDINATOR_H
+
+#include <Arduino.h>
+#include "StepGenerator.h"
+
+#define MAX_COORDINATED_AXES 3          //maximum number of axes in a single coordinated move
+#define COORDINATOR_TIMER STEP_TIMER_1  //hardware timer generating the steps of coordinated moves
+
+
+/**
+    The MotionCoordinator class moves several stepper motors at once, so that every axis starts and arrives at the same time.
+    The coordinator is itself a StepGenerator on Timer1, with no pins, that counts the steps of the axis with the furthest 
+    to go (the dominant axis). Each time it steps, a Bresenham/DDA error term for every axis decides which of the other 
+    axes also step, so every axis moves in proportion, and all of them reach their targets on the final step.
+
+    The coordinated move follows the acceleration ramp of whichever axis would be the most limited (i.e. lowest 
+    acceleration once scaled by the share of the steps it moves), and never runs any axis faster than its set speed.
+    While an axis is part of a coordinated move, its own timer is idle, and move_to() calls on it are ignored.
+    If any axis is stopped (e.g. by a limit switch or cancel), the rest of the coordinated move is stopped with it.
+    The limit switches of every axis are checked from the coordinator's interrupt, since their own timers are idle.
+    If any axis is still moving on its own when the move starts, the axes are just sent to their targets independently.
+    Axes can be added for the next move while a coordinated move is in progress, but it can't be started until it finishes.
+
+    Example Usage:
+
+    ```
+    MotionCoordinator* coordinator = new MotionCoordinator();
+    
+    setup()
+    {
+        slide_module->motor->add_to(coordinator, 20000);    //move the slide and glue arm together
+        glue_module->motor->add_to(coordinator, 6100);
+        coordinator->start();
+        while (coordinator->is_running()) {}                //both axes arrive at the same time
+    }
+    ```
+*/
+class MotionCoordinator : public StepGenerator
+{
+public:
+    //constructor for the coordinator. Takes over Timer1
+    MotionCoordinator();
+
+    bool add(StepGenerator* axis, long target);     //add an axis to the next coordinated move. Return false if the move is full
+    void start();                                   //start moving every added axis together
+    void stop();                                    //immediately stop the coordinated move, and every axis in it
+    void clear();                                   //remove every axis added to the next coordinated move without starting it
+
+protected:
+    void begin_pulse();                             //step each axis whose turn it is, raising their step pins. Called from the Timer1 interrupt
+    void end_pulse();                               //lower the step pins raised by begin_pulse(), and hand back axes that arrived
+
+private:
+    StepGenerator* pending[MAX_COORDINATED_AXES];   //axes added for the next coordinated move
+    long pending_targets[MAX_COORDINATED_AXES];     //target of each axis added for the next move
+    int num_pending = 0;                            //number of axes added for the next move
+
+    StepGenerator* axes[MAX_COORDINATED_AXES];      //axes in the coordinated move in progress
+    long targets[MAX_COORDINATED_AXES];             //target of each axis
+    uint32_t steps[MAX_COORDINATED_AXES];           //number of steps each axis moves
+    uint32_t errors[MAX_COORDINATED_AXES];          //Bresenham error term of each axis
+    uint8_t num_axes = 0;                           //number of axes in the coordinated move in progress
+    uint32_t total = 0;                             //number of steps of the dominant axis
+    uint8_t stepped = 0;                            //bit for each axis whose step pin is raised by the current step
+};
+
+#endif
@@ -54,8 +54,8 @@ PneumaticsModule::PneumaticsModule(uint8_t pin_open, uint8_t pin_close, uint8_t
     this->state = init_state;
 
     //Initialize the arduino pins
-    pinMode(pin_open, OUTPUT);
-    pinMode(pin_close, OUTPUT);
+    open_output.begin(pin_open, OUTPUT);
+    close_output.begin(pin_close, OUTPUT);
 
     //Set the actuator to the specified intial state
     actuate();
@@ -138,12 +138,12 @@ uint8_t PneumaticsModule::getCloseState()
 
 
 /**
-    digitalWrite to the pins to actuate the pneumatics to the currently set state
+    Write to the pins to actuate the pneumatics to the currently set state
 */
 void PneumaticsModule::actuate()
 {
-    digitalWrite(pin_open, getOpenState());
-    digitalWrite(pin_close, getCloseState());
+    open_output.write(getOpenState());
+    close_output.write(getCloseState());
 }
 
 
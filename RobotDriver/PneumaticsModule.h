@@ -34,6 +34,7 @@
 #define PNEUMATICS_MODULE_H
 
 #include <Arduino.h>
+#include "FastGPIO.h"
 
 /**
     The PneumaticsModule class is a helper class for controlling pneumatics on the robot
@@ -75,6 +76,8 @@ public:
 private:
     uint8_t pin_open;           //pin connected to the open side of the pneumatics
     uint8_t pin_close;          //pin connected to the close side of the pneumatics
+    GPIOPin open_output;        //output register of the open pin, for writing it quickly
+    GPIOPin close_output;       //output register of the close pin, for writing it quickly
     bool invert_open;           //is the open pin normally closed (i.e. LOW input signal -> 12V output signal)
     bool invert_close;          //is the close pin normally closed (i.e. LOW input signal -> 12V output signal)
 
@@ -82,7 +85,7 @@ private:
 
     uint8_t getOpenState();     //return the current state of the open pin (including any inversions)
     uint8_t getCloseState();    //return the current state of the close pin (including any inversions)
-    void actuate();             //digitalWrite to the pins to set the pneumatics to the current state
+    void actuate();             //write to the pins to set the pneumatics to the current state
 };
 
 #endif
@@ -39,11 +39,11 @@
 PressModule::PressModule()
 {
     //initialize the StepperModule object for the press motor (read-only public reference). Note moter rotation direction is reversed
-    motor = new StepperModule(PIN_PRESS_PULSE, PIN_PRESS_DIRECTION, PIN_PRESS_MIN_LIMIT, PIN_PRESS_MAX_LIMIT, "press", true);
+    motor = new StepperModule(PIN_PRESS_PULSE, PIN_PRESS_DIRECTION, PIN_PRESS_MIN_LIMIT, PIN_PRESS_MAX_LIMIT, PRESS_STEP_TIMER, "press", true);
     
     //set motor speeds and acceleration
     motor->set_speeds(PRESS_MINIMUM_SPEED, PRESS_MEDIUM_SPEED, PRESS_MAXIMUM_SPEED);
-    motor->set_acceleration(PRESS_ACCELERATION);
+    motor->set_acceleration(PRESS_ACCELERATION, PRESS_DECELERATION);
 
     //initilize the pneumatics to control the press and snips
     press = new PneumaticsModule(PIN_PRESS_OPEN, PIN_PRESS_CLOSE, PRESS_DEFAULT);
@@ -61,12 +61,26 @@ PressModule::PressModule()
 */
 int PressModule::calibrate()
 {
-    num_errors = 0;
-    num_errors += motor->calibrate();
+    start_calibrate();
+    while (is_busy())
+    {
+        update();
+    }
     return check_errors();
 }
 
 
+/**
+    Begin calibrating the press stepper motor step position without blocking. Progressed by update()
+*/
+void PressModule::start_calibrate()
+{
+    num_errors = -1;                    //not calibrated until the calibration completes
+    calibrating = true;
+    motor->start_calibrate();
+}
+
+
 /**
     Check if any errors occured during calibration, and the module needs to be recalibrated
 */
@@ -94,22 +108,151 @@ int PressModule::check_errors()
 */
 void PressModule::press_slot()
 {
-    if (!has_wire())    //check if wire is still remaining
+    start_press_slot();     //begin the press operation
+    while (!done())         //block until the fret is pressed and cut
     {
-        delay(500);     //pause to stop slide momentum
-        return;         //return before attempting to press with no wire
+        run();
     }
+}
 
-    motor->move_absolute(PRESS_PRESS_POSITION, true);   //rotate the press arm to the position it will press the frets
-    press->write(LOW);                                  //lower the press arm
-    delay(PNEUMATICS_DELAY);                            //wait for the press to actuate
-    delay(PRESS_DURATION);                              //delay for a moment to allow the fret to be completely pressed into the slot
-    press->write(HIGH);                                 //raise the press
-    delay(PNEUMATICS_DELAY);                            //wait for the press to raise before actuating
-    motor->move_absolute(PRESS_SNIPS_POSITION, true);   //rotate the press arm to the position the snips will cut at
-    snips->write(HIGH);                                 //close the snips
-    delay(PNEUMATICS_DELAY);                            //wait for the pneumatics to close completely
-    snips->write(LOW);                                  //open the snips back up
+
+/**
+    Begin pressing and cutting a fret into the slot currently aligned with the press, without blocking.
+    run() must be called each loop to progress the operation, and done() indicates when it has finished
+*/
+void PressModule::start_press_slot()
+{
+    timestamp = millis();
+    if (!has_wire())                                    //check if wire is still remaining
+    {
+        state = PRESS_NO_WIRE;                          //pause to stop slide momentum, without attempting to press with no wire
+        return;
+    }
+
+    motor->move_absolute(PRESS_PRESS_POSITION);         //rotate the press arm to the position it will press the frets
+    state = PRESS_ROTATE;
+}
+
+
+/**
+    Progress the current press operation. THIS NEEDS TO BE CALLED ONCE PER LOOP() while a fret is being pressed
+*/
+void PressModule::run()
+{
+    motor->run();                                       //run the press motor (and check limits)
+    unsigned long elapsed = millis() - timestamp;       //time spent in the current step
+
+    switch (state)
+    {
+        case PRESS_NO_WIRE:         //pause to stop slide momentum
+        {
+            if (elapsed >= 500) { state = PRESS_IDLE; }
+        }
+        break;
+
+        case PRESS_ROTATE:          //wait for the arm to reach the press position, and then lower the press
+        {
+            if (motor->is_running()) { break; }
+            press->write(LOW);
+            timestamp = millis();
+            state = PRESS_LOWERED;
+        }
+        break;
+
+        case PRESS_LOWERED:         //wait for the press to actuate, and for the fret to be completely pressed into the slot
+        {
+            if (elapsed < PNEUMATICS_DELAY + PRESS_DURATION) { break; }
+            press_time = timestamp + PNEUMATICS_DELAY;  //the fret was seated once the press finished lowering
+            press->write(HIGH);
+            timestamp = millis();
+            state = PRESS_RAISE;
+        }
+        break;
+
+        case PRESS_RAISE:           //wait for the press to raise before rotating to the position the snips will cut at
+        {
+            if (elapsed < PNEUMATICS_DELAY) { break; }
+            motor->move_absolute(PRESS_SNIPS_POSITION);
+            state = PRESS_ROTATE_SNIPS;
+        }
+        break;
+
+        case PRESS_ROTATE_SNIPS:    //wait for the arm to reach the snips position, and then close the snips
+        {
+            if (motor->is_running()) { break; }
+            snips->write(HIGH);
+            timestamp = millis();
+            state = PRESS_CUT;
+        }
+        break;
+
+        case PRESS_CUT:             //wait for the pneumatics to close completely, and then open the snips back up
+        {
+            if (elapsed < PNEUMATICS_DELAY) { break; }
+            snips->write(LOW);
+            state = PRESS_IDLE;
+        }
+        break;
+    }
+}
+
+
+/**
+    Return whether or not the current press operation has finished
+
+    @return bool done is true if no fret is currently being pressed, otherwise false
+*/
+bool PressModule::done()
+{
+    return state == PRESS_IDLE;
+}
+
+
+/**
+    Return the time the most recent fret was seated in its slot (i.e. once the press finished lowering)
+
+    @return unsigned long press_time is the time in milliseconds (from millis())
+*/
+unsigned long PressModule::get_press_time()
+{
+    return press_time;
+}
+
+
+/**
+    Run the press motor, progress any press operation, and record the result of any calibration once it completes.
+    THIS NEEDS TO BE CALLED ONCE PER LOOP()
+*/
+void PressModule::update()
+{
+    run();
+    if (calibrating && !motor->is_calibrating())
+    {
+        calibrating = false;
+        num_errors = motor->get_calibration_result();
+    }
+}
+
+
+/**
+    Return whether or not the press arm is moving, pressing, or calibrating
+
+    @return bool busy is true if the press module has an action in progress, else false
+*/
+bool PressModule::is_busy()
+{
+    return !done() || calibrating || motor->is_busy();
+}
+
+
+/**
+    Stop the press arm, and abandon any press operation or calibration in progress
+*/
+void PressModule::cancel()
+{
+    state = PRESS_IDLE;
+    calibrating = false;
+    motor->cancel();
 }
 
 
@@ -137,6 +280,7 @@ bool PressModule::has_wire()
 */
 void PressModule::reset()
 {
+    state = PRESS_IDLE;                                 //cancel any press operation in progress
     snips->write(LOW);                                  //open the snips
     press->write(HIGH);                                 //raise the press
     motor->move_absolute(PRESS_CLEAR_POSITION, true);   //move clear and block till finished
@@ -150,6 +294,7 @@ void PressModule::reset()
 String PressModule::str()
 {
     return "Press Motor Position: " + String(motor->get_current_position()) +
+           "\nPress Step Timing: " + motor->step_timing() +
            "\nPress: " + String(press->read() == HIGH ? "RAISED" : "LOWERED") +
            "\nSnips: " + String(snips->read() == HIGH ? "CLOSED" : "OPEN") + 
            "\nPress Feed: " + String(has_wire() ? "HAS WIRE" : "OUT OF WIRE");
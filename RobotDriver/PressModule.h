@@ -37,11 +37,14 @@
 #include "StepperModule.h"
 #include "PneumaticsModule.h"
 #include "ButtonModule.h"
+#include "TaskEngine.h"
 
-#define PRESS_MAXIMUM_SPEED 4000        //maximum speed of stepper motor (steps/second). Don't set this to more than 4000
+#define PRESS_MAXIMUM_SPEED 8000        //maximum (cruise) speed of stepper motor (steps/second). Reached by ramping up, see PRESS_ACCELERATION
 #define PRESS_MEDIUM_SPEED 1000         //nominal speed of the stepper motor
 #define PRESS_MINIMUM_SPEED 50          //speed for moving slowly (e.g. during calibration)
-#define PRESS_ACCELERATION 100000       //acceleration of stepper motor (steps/second^2). Basically infinite, i.e. no ramp up/down.
+#define PRESS_ACCELERATION 60000        //acceleration of stepper motor (steps/second^2). Trapezoidal profile
+#define PRESS_DECELERATION 60000        //deceleration of stepper motor (steps/second^2)
+#define PRESS_STEP_TIMER STEP_TIMER_5   //hardware timer generating the step pulses for the press motor
      
 #define PIN_PRESS_MIN_LIMIT 39          //pin for controlling the laser diode
 #define PIN_PRESS_MAX_LIMIT 33          //pin for sensing the laser beam
@@ -63,15 +66,24 @@
 
 #define PNEUMATICS_DELAY 800            //amount of time it take the pneumatics to acuate
 
-class PressModule
+class PressModule : public Task
 {
 public:
 	//Constructor for press module object
 	PressModule();
 
     int calibrate();                    //raise the press, rotate to the minimum limit, and set as origin 
+    void start_calibrate();             //begin calibrating the press motor without blocking
     int check_errors();                 //check how many errors the press module currently has
-    void press_slot();                  //perform all steps to press a fret
+    void press_slot();                  //perform all steps to press a fret (blocking)
+    void start_press_slot();            //begin pressing a fret without blocking. Call run() until done() returns true
+    void run();                         //NEEDS TO BE CALLED ONCE PER LOOP() while a fret is being pressed
+    bool done();                        //return whether or not the current press operation has finished
+    unsigned long get_press_time();     //return the time (millis) the most recent fret was seated in its slot
+
+    void update();                      //NEEDS TO BE CALLED ONCE PER LOOP(). Run the press motor, and progress any press operation or calibration
+    bool is_busy();                     //return whether or not the press arm is moving, pressing, or calibrating
+    void cancel();                      //stop the press arm, and abandon any press operation or calibration
     bool has_wire();                    //check if there is still wire in the press feed
     void reset();                       //reset the press to a good starting position
 
@@ -86,6 +98,32 @@ public:
 
 private:
     int num_errors = -1;
+    bool calibrating = false;           //whether or not a calibration is in progress
+
+    enum press_states
+    {
+        PRESS_IDLE,                     //no press operation in progress
+        PRESS_NO_WIRE,                  //out of wire. pausing to let the slide momentum stop
+        PRESS_ROTATE,                   //rotating the press arm to the press position
+        PRESS_LOWERED,                  //press is lowered, and holding the fret into the slot
+        PRESS_RAISE,                    //waiting for the press to raise
+        PRESS_ROTATE_SNIPS,             //rotating the press arm to the snips position
+        PRESS_CUT                       //waiting for the snips to close
+
+        //Transitions are as follows:
+        //PRESS_IDLE          ->  PRESS_ROTATE        :  when start_press_slot() is called with wire in the feed
+        //PRESS_IDLE          ->  PRESS_NO_WIRE       :  when start_press_slot() is called without any wire in the feed
+        //PRESS_NO_WIRE       ->  PRESS_IDLE          :  after a short pause
+        //PRESS_ROTATE        ->  PRESS_LOWERED       :  arm reaches the press position, and the press is lowered
+        //PRESS_LOWERED       ->  PRESS_RAISE         :  after PNEUMATICS_DELAY + PRESS_DURATION, the press is raised
+        //PRESS_RAISE         ->  PRESS_ROTATE_SNIPS  :  after PNEUMATICS_DELAY
+        //PRESS_ROTATE_SNIPS  ->  PRESS_CUT           :  arm reaches the snips position, and the snips are closed
+        //PRESS_CUT           ->  PRESS_IDLE          :  after PNEUMATICS_DELAY, the snips are opened
+    };
+
+    press_states state = PRESS_IDLE;    //current step of the press operation
+    unsigned long timestamp = 0;        //time (in milliseconds) that the current step started
+    unsigned long press_time = 0;       //time (in milliseconds) that the most recent fret was seated
 };
 
 #endif
\ No newline at end of file
@@ -50,23 +50,56 @@ Robot::Robot()
     left_start = new ButtonModule(PIN_LEFT_START_BUTTON);
     right_start = new ButtonModule(PIN_RIGHT_START_BUTTON);
 
-    //load the alignment offset variables from EEPROM
+    //create the scheduler for planning glue/press batches
+    scheduler = new SlotScheduler();
+    scheduler->set_slide_acceleration(SLIDE_ACCELERATION);
+
+    //create the catalog for identifying boards from their slots
+    catalog = new BoardCatalog();
+
+    //create the planner for speeding up the slide between slots while detecting them
+    planner = new ScanPlanner();
+
+    //create the coordinator for moving the slide and the glue/press arms together
+    coordinator = new MotionCoordinator();
+
+    //register every module (and the robot's own sequences) with the task engine so they can all run concurrently
+    engine = new TaskEngine();
+    engine->add(slide_module);
+    engine->add(laser_module);
+    engine->add(glue_module);
+    engine->add(press_module);
+    engine->add(this);
+
+    //load the alignment offset variables, batch size and board scale length range from EEPROM
     load_offsets();
+    load_batch_size();
+    load_scale_range();
+
+    //if the robot was switched off while parked, the next calibration only needs to verify the saved motor positions
+    load_park();
 }
 
 
 /**
-    Run all calibration process on the robot, and keep track of number of errors
+    Run all calibration process on the robot, and keep track of number of errors.
+    Every axis has its own limit switches, so all of them home at the same time, 
+    and the laser ambient/active response is sampled while they move. Blocks until every calibration is complete
 
     @return int result is the number of errors that occured during calibration. 0 means no errors, result > 0 means errors occurred
 */
 int Robot::calibrate()
 {
-    slide_module->calibrate();    //move the slide to the minimum limit
-    glue_module->calibrate();     //move the glue motor to the minimum limit. calibrate the IR sensor? 
-    press_module->calibrate();    //raise the press and move the press motor to the minimum limit
-    laser_module->calibrate();    //check the ambient brightness
+    unsigned long start = millis();
+    unpark();
+
+    slide_module->start_calibrate();    //move the slide to the minimum limit
+    glue_module->start_calibrate();     //move the glue motor to the minimum limit. calibrate the IR sensor? 
+    press_module->start_calibrate();    //move the press motor to the minimum limit
+    laser_module->start_calibrate();    //check the ambient brightness
+    engine->wait();                     //run every calibration together until they have all finished
 
+    Serial.println("Calibration finished in " + String(millis() - start) + "ms");
     return check_errors();
 }
 
@@ -106,6 +139,12 @@ int Robot::check_errors(bool laser, bool slide, bool glue, bool press)
 */
 int Robot::detect_slots()
 {
+    unpark();
+    if (process_mode == STREAM_MODE)                //glue and press slots as they are detected
+    {
+        return stream_slots();
+    }
+
     //check if laser and slide modules have errors
     if (check_errors(true, true, false, false))     //check only the slide and laser module (press/glue not needed for this process)
     { 
@@ -115,35 +154,242 @@ int Robot::detect_slots()
     //run fret slot detection process
     Serial.println("Detecting slots on fret board");
     laser_module->write(HIGH);                      //turn on the laser emitter
+    unsigned long start_time = millis();
+    planner->start(slide_module->motor);            //scan slowly until the slots can be predicted
     slide_module->motor->move_relative(LONG_MAX);   //command the slide motor to a very far position forward
     
     while (!laser_module->done())                   //while there we haven't reached the end of the board yet
     {
         slide_module->motor->run();                 //run the stepper motor
         laser_module->detect_slots(true);           //run the laser detection algorithm, and print out updates
+        planner->update(slide_module->motor->get_current_position(), laser_module->get_slots(), slide_module->motor);  //speed up between predicted slots
     }
     slide_module->motor->stop();
+    slide_module->motor->set_speed(SLIDE_MAXIMUM_SPEED);
     // laser_module->write(LOW);                       //turn off the laser
 
-    slot_buffer = laser_module->get_slot_buffer();
-    num_slots = laser_module->get_num_slots();
+    Serial.println("Detected " + String(laser_module->get_num_slots()) + " slots in " + String((millis() - start_time) / 1000.0) + " seconds");
+    Serial.println(planner->str());
+    for (int i = 0; i < laser_module->get_num_slots(); i++)
+    {
+        if (laser_module->get_slot_confidence(i) < LOW_SLOT_CONFIDENCE)
+        {
+            Serial.println("Warning: slot " + String(i) + " was detected with low confidence (" + String(laser_module->get_slot_confidence(i)) + ")");
+        }
+    }
+
+    //check that the slots detected match a board model. If so, drop spurious slots (and fill in missing ones where the fit allows)
+    if (catalog->fit(laser_module->get_slots(), laser_module->get_board_start(), laser_module->get_board_end()))
+    {
+        catalog->correct(laser_module->get_slots());
+        Serial.println(catalog->str());
+    }
+    else                                            //the slots are still used as detected
+    {
+        Serial.println(catalog->str());
+        Serial.println("Warning: detected slots don't match any board in the catalog. Check them before pressing");
+    }
+
+    scheduler->load(laser_module->get_slots());     //create a record for each slot to track glue/press progress
+    num_slots = scheduler->get_num_slots();
+    return 0;
+}
+
+
+/**
+    Detect slots on the board, and glue and press them while the laser is still scanning (STREAM_MODE).
+    The laser is upstream of the glue needle, which is upstream of the press, so as the slide moves forward 
+    each slot passes the laser, then the glue needle, then the press. The slide stops at each glue/press 
+    position in order, and resumes scanning in between. A slot is only glued if every slot with glue 
+    waiting will still be pressed before the glue deadline, otherwise it is left for press_frets()
+
+    @return int result is 0 for success, or 1 if there were errors
+*/
+int Robot::stream_slots()
+{
+    if (check_errors() > 0) { return 1; }           //streaming uses every module
+
+    Serial.println("Detecting slots on fret board, and gluing/pressing them while scanning");
+    scheduler->clear();
+    scheduler->start_board();
+    laser_module->write(HIGH);                      //turn on the laser emitter
+
+    int glue_index = 0;                             //next slot to pass the glue needle
+    int press_index = 0;                            //oldest slot that may have glue waiting for the press
+    long target = LONG_MAX;                         //current target of the slide. LONG_MAX while scanning for the next slot
+    slide_module->motor->move_absolute(target);
+
+    while (true)
+    {
+        //create a record for any slots that were just detected
+        while (scheduler->get_num_slots() < laser_module->get_num_slots())
+        {
+            if (scheduler->add(laser_module->get_slot_position(scheduler->get_num_slots())) < 0) { break; }
+        }
+        num_slots = scheduler->get_num_slots();
+
+        //find the next glue and press positions along the slide
+        while (press_index < glue_index && scheduler->get(press_index)->state != SLOT_GLUED) { press_index++; }
+        bool gluing = glue_index < num_slots;
+        bool pressing = press_index < glue_index;
+        long glue_target = gluing ? scheduler->get(glue_index)->position + GLUE_ALIGNMENT_OFFSET : LONG_MAX;
+        long press_target = pressing ? scheduler->get(press_index)->position + PRESS_ALIGNMENT_OFFSET : LONG_MAX;
+
+        if (!gluing && !pressing && laser_module->done()) { break; }    //whole board scanned, and every slot handled
+
+        long next = min(glue_target, press_target);
+        if (gluing && pressing && abs(glue_target - press_target) <= PIPELINE_TOLERANCE)
+        {
+            next = press_target;                    //align the press exactly, and glue at the same position
+        }
+        if (next != target)                         //a closer stop was found (or the last stop was reached)
+        {
+            target = next;
+            slide_module->motor->move_absolute(target);
+            if (!gluing || abs(glue_target - target) > PIPELINE_TOLERANCE)
+            {
+                glue_module->motor->move_absolute(GLUE_CLEAR_POSITIVE);     //move the glue arm clear of the clip, unless it is about to glue
+            }
+        }
+
+        if (target != LONG_MAX && slide_module->motor->get_current_position() == target)    //arrived at a stop
+        {
+            if (check_errors() > 0) { break; }      //if the robot has any errors, stop the sequence
+
+            //glue here if the next slot lines up with the needle, and gluing it won't make any waiting slot late
+            int glue_slot = -1;
+            if (gluing && abs(glue_target - target) <= PIPELINE_TOLERANCE)
+            {
+                if (scheduler->can_stream_glue(glue_index, target, PRESS_ALIGNMENT_OFFSET))
+                {
+                    glue_slot = glue_index;
+                }
+                else
+                {
+                    Serial.println("Leaving slot " + String(glue_index) + " for after the scan, to keep glued slots within the deadline");
+                }
+                glue_index++;
+            }
+            int press_slot = pressing && abs(press_target - target) <= PIPELINE_TOLERANCE ? press_index : -1;
+
+            run_stations(glue_slot, press_slot, true);
+            target = LONG_MAX;                      //resume scanning towards the next stop
+            slide_module->motor->move_absolute(target);
+        }
+
+        engine->run();
+        laser_module->detect_slots(true);           //run the laser detection algorithm, and print out updates
+    }
+    slide_module->motor->stop();
+    press_module->reset();
 
-    //perform check to see if slots detected match existing board models
     Serial.println("Detected " + String(num_slots) + " slots");
 
-    return 0;   //for now return success. TODO: have a warning if the board detected doesn't match either the 22 or 24 fret board
+    //slots have already been glued/pressed, so the board model is only checked (not used to correct the slots)
+    bool matched = catalog->fit(laser_module->get_slots(), laser_module->get_board_start(), laser_module->get_board_end());
+    Serial.println(catalog->str());
+    if (!matched) { Serial.println("Warning: detected slots don't match any board in the catalog"); }
+    return 0;
 }
 
 
 /**
-    Glue and press each fret detected
+    Glue and press each fret detected, using the current process mode
 */
 void Robot::press_frets()
 {
     if (check_errors() > 0) { return; }                 //cancel fret press/cut process if there are errors
+    unpark();
 
+    if (process_mode != STREAM_MODE)                    //when streaming, the board was started by detect_slots()
+    {
+        scheduler->start_board();
+    }
+    if (plan_order() > 0)
+    {
+        if (process_mode == BATCH_MODE)
+        {
+            press_frets_batched();
+        }
+        else                                            //slots left over after streaming are processed as in PIPELINE_MODE
+        {
+            press_frets_pipelined();
+        }
+    }
+    scheduler->finish_board();
+}
+
+
+/**
+    Set the order used to glue and press frets
+
+    @param process_modes mode is either BATCH_MODE (glue a batch, then press the batch) or PIPELINE_MODE (overlap glue/press where possible)
+*/
+void Robot::set_process_mode(process_modes mode)
+{
+    process_mode = mode;
+    Serial.println("Process mode set to " + String(mode == STREAM_MODE ? "STREAM" : mode == PIPELINE_MODE ? "PIPELINE" : "BATCH"));
+}
+
+
+/**
+    Set whether detect_slots() scans the whole board at SLIDE_SCAN_SPEED, or only slows down around predicted slots.
+    STREAM_MODE isn't planned, as the slide stops at the glue/press stations between slots anyway
+
+    @param scan_modes mode is UNIFORM_SCAN or ADAPTIVE_SCAN
+*/
+void Robot::set_scan_mode(scan_modes mode)
+{
+    planner->set_mode(mode);
+}
+
+
+/**
+    Set which end of the board gluing and pressing starts from.
+    After detect_slots() the slide is past the last slot, so REVERSE_ORDER (or NEAREST_ORDER) avoids 
+    traversing the whole board back to the first slot, and finishes near the home position
+
+    @param process_orders order is FORWARD_ORDER, REVERSE_ORDER, or NEAREST_ORDER
+*/
+void Robot::set_process_order(process_orders order)
+{
+    process_order = order;
+}
+
+
+/**
+    Choose the processing order for the slots left on the current board, and pass it to the scheduler.
+    For NEAREST_ORDER, the end of the board with the slot nearest the glue needle is processed first
+
+    @return int num_steps is the number of slots left to process
+*/
+int Robot::plan_order()
+{
+    bool reverse = process_order == REVERSE_ORDER;
+    int num_steps = scheduler->set_order(false);
+    if (process_order == NEAREST_ORDER && num_steps > 0)
+    {
+        long position = slide_module->motor->get_current_position();
+        long first = scheduler->get(scheduler->slot_at(0))->position + GLUE_ALIGNMENT_OFFSET;
+        long last = scheduler->get(scheduler->slot_at(num_steps - 1))->position + GLUE_ALIGNMENT_OFFSET;
+        reverse = abs(position - last) < abs(position - first);
+    }
+    num_steps = scheduler->set_order(reverse);
+    Serial.println(String(num_steps) + " slots left to process " + (reverse ? "from last to first" : "from first to last"));
+    return num_steps;
+}
+
+
+/**
+    Glue and press each fret detected in strict batches. 
+    Glue a batch of slots, move the glue arm clear, and then press the same slots.
+    Each batch is SLOT_BATCH_SIZE slots, or if auto-tuning, sized by the scheduler to meet the glue deadline
+*/
+void Robot::press_frets_batched()
+{
     Serial.println("Gluing and pressing frets into all slots");
-    int index = 0;                                      //start of the current group of frets
+    int index = 0;                                      //processing step of the start of the current group of frets
+    int num_steps = scheduler->get_num_steps();         //number of slots left to process
 
     glue_module->set_direction(1);                      //set the initial direction of the glue to be negative, so that the clip will be avoided
 
@@ -151,37 +397,361 @@ void Robot::press_frets()
     {
         if (check_errors() > 0) { break; }              //if the robot has any errors, stop the sequence
         
+        int batch = scheduler->plan_batch(index, slide_module->motor->get_current_position(), GLUE_ALIGNMENT_OFFSET, PRESS_ALIGNMENT_OFFSET, SLOT_BATCH_SIZE);
+        Serial.println("Processing batch of " + String(batch) + " slots starting at slot " + String(scheduler->slot_at(index)));
+
         //glue group loop
-        for (int i = 0; i < SLOT_BATCH_SIZE; i++)       //loop through the group for glue
+        for (int i = 0; i < batch; i++)                 //loop through the group for glue
         {
             if (check_errors() > 0) { break; }          //break loop if the robot has errors
-            if (index + i >= num_slots) { break; }      //break loop if at the end of the frets
+            if (index + i >= num_steps) { break; }      //break loop if at the end of the frets
             
             //go to the next glue slot and lay glue in the slot
-            long target = slot_buffer[index+i] + GLUE_ALIGNMENT_OFFSET;
-            slide_module->motor->move_absolute(target, true);
-            glue_module->glue_slot();
+            int slot = scheduler->slot_at(index+i);
+            move_slide(scheduler->get(slot)->position + GLUE_ALIGNMENT_OFFSET, false);
+            run_stations(slot, -1);
         }
-        //glue_module->reset();                           //move the glue module out of the way of the fret board clamp
-        glue_module->motor->move_absolute(6100, true);  //move glue arm out of the way of the clip
 
         //press/cut group loop
-        for (int i = 0; i < SLOT_BATCH_SIZE; i++)       //loop through the group for press
+        for (int i = 0; i < batch; i++)                 //loop through the group for press
         {
             if (check_errors() > 0) { break; }          //break loop if the robot has errors
-            if (index + i >= num_slots) { break; }      //break loop if at the end of the frets
+            if (index + i >= num_steps) { break; }      //break loop if at the end of the frets
             
-            //go to next press slot and press/cut the fret in the slot
-            long target = slot_buffer[index+i] + PRESS_ALIGNMENT_OFFSET;
-            slide_module->motor->move_absolute(target, true);
-            press_module->press_slot();
+            //go to next press slot and press/cut the fret in the slot. The glue arm is moved clear of the clip on the way to the first
+            int slot = scheduler->slot_at(index+i);
+            move_slide(scheduler->get(slot)->position + PRESS_ALIGNMENT_OFFSET, i == 0);
+            run_stations(-1, slot);
         }
         press_module->reset();
         delay(1000);                                    //delay so that the slide doesn't start moving until after the wire has settled after being snipped
         
-        index += SLOT_BATCH_SIZE;                       //move to the next group of slots
-        if (index >= num_slots) { break; }              //if last group, exit loop
+        index += batch;                                 //move to the next group of slots
+        if (index >= num_steps) { break; }              //if last group, exit loop
+    }
+    scheduler->report();
+}
+
+
+/**
+    Glue and press each fret detected, keeping the glue arm and press arm working at the same time where possible.
+    Slots are still glued in batches ahead of the press (fixed or auto-tuned), and pressed in the order they were glued.
+    Whenever the slide position for pressing one slot also puts the glue needle (within PIPELINE_TOLERANCE) over the next 
+    slot to glue, both stations work at that position simultaneously. The glue arm is also moved clear of the clip while 
+    the slide travels, instead of before it.
+*/
+void Robot::press_frets_pipelined()
+{
+    Serial.println("Gluing and pressing frets into all slots (pipelined)");
+    int glue_index = 0;                                 //processing step of the next slot to be glued
+    int press_index = 0;                                //processing step of the next slot to be pressed. Steps in [press_index, glue_index) have glue waiting
+    int num_steps = scheduler->get_num_steps();         //number of slots left to process
+    bool stopped = false;                               //set if the robot has errors, to stop the sequence after resetting the press
+
+    while (press_index < num_steps && !stopped)
+    {
+        if (check_errors() > 0) { break; }              //if the robot has any errors, stop the sequence
+
+        int batch = scheduler->plan_batch(press_index, slide_module->motor->get_current_position(), GLUE_ALIGNMENT_OFFSET, PRESS_ALIGNMENT_OFFSET, SLOT_BATCH_SIZE);
+        Serial.println("Processing batch of " + String(batch) + " slots starting at slot " + String(scheduler->slot_at(press_index)));
+
+        //glue group loop: glue ahead of the press until the batch is full
+        while (glue_index < num_steps && glue_index - press_index < batch)
+        {
+            if (check_errors() > 0) { stopped = true; break; }     //stop the sequence if the robot has errors
+
+            int glue_slot = scheduler->slot_at(glue_index);
+            int press_slot = scheduler->slot_at(press_index);
+            long glue_target = scheduler->get(glue_slot)->position + GLUE_ALIGNMENT_OFFSET;
+            long press_target = scheduler->get(press_slot)->position + PRESS_ALIGNMENT_OFFSET;
+            bool overlap = press_index < glue_index     //check if the oldest glued slot lines up with the press at this position (never in reverse order)
+                && abs(press_target - glue_target) <= PIPELINE_TOLERANCE;
+
+            if (overlap)                                //align the press exactly, and glue at the same position
+            {
+                move_slide(press_target, false);
+                run_stations(glue_slot, press_slot);
+                glue_index++;
+                press_index++;
+            }
+            else
+            {
+                move_slide(glue_target, false);
+                run_stations(glue_slot, -1);
+                glue_index++;
+            }
+        }
+
+        //press group loop: press every slot with glue waiting, gluing the next slot at the same time if it lines up
+        while (press_index < glue_index)
+        {
+            if (check_errors() > 0) { stopped = true; break; }     //stop the sequence if the robot has errors
+
+            int press_slot = scheduler->slot_at(press_index);
+            long press_target = scheduler->get(press_slot)->position + PRESS_ALIGNMENT_OFFSET;
+            bool overlap = glue_index < num_steps       //check if the next slot to glue lines up with the glue needle at this position
+                && glue_index - press_index < batch
+                && abs(scheduler->get(scheduler->slot_at(glue_index))->position + GLUE_ALIGNMENT_OFFSET - press_target) <= PIPELINE_TOLERANCE;
+
+            move_slide(press_target, !overlap);         //move the glue arm clear of the clip while moving, unless it is about to glue
+            run_stations(overlap ? scheduler->slot_at(glue_index++) : -1, press_slot);
+            press_index++;
+        }
+
+        press_module->reset();
+        if (stopped) { break; }                         //skip the settling delay, as the slide won't move again
+        delay(1000);                                    //delay so that the slide doesn't start moving until after the wire has settled after being snipped
+    }
+    scheduler->report();
+}
+
+
+/**
+    Move the slide to the target position and block until it arrives. 
+    If specified, the glue arm is moved clear of the fretboard clamp at the same time, as a coordinated move so that both arrive together.
+    If the glue arm is still finishing its pass, they move independently instead.
+    The time taken is recorded by the scheduler to keep its timing model up to date
+
+    @param long target is the absolute step position to move the slide to
+    @param bool park_glue indicates whether the glue arm should be moved to GLUE_CLEAR_POSITIVE during the move
+*/
+void Robot::move_slide(long target, bool park_glue)
+{
+    unsigned long start = millis();
+    long distance = target - slide_module->motor->get_current_position();
+
+    if (park_glue)
+    {
+        slide_module->motor->add_to(coordinator, target);
+        glue_module->motor->add_to(coordinator, GLUE_CLEAR_POSITIVE);
+        coordinator->start();
+    }
+    else
+    {
+        slide_module->motor->move_absolute(target);
+    }
+
+    while (coordinator->is_running() || slide_module->motor->is_running() || glue_module->motor->is_running())
+    {
+        engine->run();
+    }
+
+    scheduler->record_slide(distance, millis() - start);
+}
+
+
+/**
+    Glue and/or press slots at the current slide position, and block until both stations have finished.
+    The glue pass starts from whichever side of the board the needle is already on.
+    Glue/press times are recorded for each slot, and the scheduler timing model is updated
+
+    @param int glue_index is the index of the slot under the glue needle, or -1 to not glue
+    @param int press_index is the index of the slot under the press, or -1 to not press
+    @param (optional) bool scanning indicates if the laser is scanning the board, so its samples are taken while waiting. Default is false
+*/
+void Robot::run_stations(int glue_index, int press_index, bool scanning)
+{
+    unsigned long start = millis();
+    bool gluing = glue_index >= 0;
+    bool pressing = press_index >= 0;
+
+    if (gluing)
+    {
+        if (process_mode != BATCH_MODE)             //start the glue pass from the side of the board the needle is already on
+        {
+            glue_module->set_direction(glue_module->motor->get_current_position() > CENTER_POSITION ? -1 : 1);
+        }
+        glue_module->start_glue_slot();
+    }
+    if (pressing)
+    {
+        press_module->start_press_slot();
+    }
+
+    while (gluing || pressing)
+    {
+        engine->run();
+        if (scanning) { laser_module->detect_slots(true); }    //keep taking laser samples, so the sampler buffer doesn't overflow
+
+        if (gluing && glue_module->done())          //glue pass complete. record when the glue was laid
+        {
+            gluing = false;
+            scheduler->record_glue(millis() - start);
+            scheduler->mark_glued(glue_index, glue_module->get_glue_time());
+        }
+        if (pressing && press_module->done())       //press complete. record when the fret was seated (unless there was no wire to press)
+        {
+            pressing = false;
+            unsigned long press_time = press_module->get_press_time();
+            if (press_time >= start)
+            {
+                scheduler->record_press(press_time - start, millis() - start);
+                scheduler->mark_pressed(press_index, press_time);
+            }
+        }
+    }
+}
+
+
+/**
+    Begin gluing the specified detected slot without blocking. The sequence is progressed by update()
+
+    @param int index is the index of the slot to glue, or -1 to glue every slot in order
+*/
+void Robot::start_glue_slots(int index)
+{
+    if (!start_sequence(index, true)) return;
+
+    if (index < 0)
+    {
+        glue_module->set_direction(1);                  //set the glue to start in the positive direction
+        glue_module->motor->move_absolute(12000);       //move the glue motor out of the way of the slide
+    }
+}
+
+
+/**
+    Begin pressing the specified detected slot without blocking. The sequence is progressed by update()
+
+    @param int index is the index of the slot to press, or -1 to press every slot in order
+*/
+void Robot::start_press_slots(int index)
+{
+    if (!start_sequence(index, false)) return;
+
+    if (index < 0)
+    {
+        press_module->motor->move_absolute(5000);       //move the press motor to the maximum limit
+    }
+}
+
+
+/**
+    Set up a glue/press sequence over the slots detected by the laser
+
+    @param int index is the index of the slot to target, or -1 to target every slot in order
+    @param bool glue is true to glue the slots, or false to press them
+    @return bool started is true if the sequence was started, or false if the index was invalid
+*/
+bool Robot::start_sequence(int index, bool glue)
+{
+    int num_slots = laser_module->get_num_slots();
+
+    if (index >= num_slots)                             //confirm the index refers to a real slot
+    {
+        Serial.println("Error: Specified slot index \"" + String(index) + "\" is larger than max slot index " + String(num_slots - 1));
+        return false;
+    }
+
+    sequence_glue = glue;
+    if (index >= 0)
+    {
+        sequence_index = index;
+        sequence_end = index + 1;
+        move_sequence_slide();
+        sequence_state = SEQUENCE_MOVE;
+    }
+    else
+    {
+        sequence_index = 0;
+        sequence_end = num_slots;
+        sequence_state = SEQUENCE_PREPARE;
     }
+    return true;
+}
+
+
+/**
+    Start moving the slide so that the sequence station is aligned with the current slot in the sequence
+*/
+void Robot::move_sequence_slide()
+{
+    long offset = sequence_glue ? GLUE_ALIGNMENT_OFFSET : PRESS_ALIGNMENT_OFFSET;
+    slide_module->motor->move_absolute(laser_module->get_slot_position(sequence_index) + offset);
+}
+
+
+/**
+    Progress any glue/press sequence started by start_glue_slots() or start_press_slots().
+    THIS NEEDS TO BE CALLED ONCE PER LOOP() (the TaskEngine does this automatically)
+*/
+void Robot::update()
+{
+    if (slide_module->motor->is_running() || glue_module->motor->is_running() || press_module->motor->is_running())
+    {
+        unpark();                                       //e.g. a manual move from the serial commands
+    }
+
+    switch (sequence_state)
+    {
+        case SEQUENCE_IDLE: break;
+
+        case SEQUENCE_PREPARE:
+        {
+            bool preparing = sequence_glue ? glue_module->is_busy() : press_module->is_busy();
+            if (preparing) break;
+            if (sequence_index >= sequence_end)         //no slots to visit
+            {
+                sequence_state = SEQUENCE_IDLE;
+                break;
+            }
+            move_sequence_slide();
+            sequence_state = SEQUENCE_MOVE;
+            break;
+        }
+
+        case SEQUENCE_MOVE:
+        {
+            if (slide_module->is_busy()) break;
+            if (sequence_glue)
+            {
+                glue_module->start_glue_slot();
+            }
+            else
+            {
+                press_module->start_press_slot();
+            }
+            sequence_state = SEQUENCE_ACTION;
+            break;
+        }
+
+        case SEQUENCE_ACTION:
+        {
+            bool acting = sequence_glue ? glue_module->is_busy() : press_module->is_busy();
+            if (acting) break;
+            if (++sequence_index < sequence_end)
+            {
+                move_sequence_slide();
+                sequence_state = SEQUENCE_MOVE;
+            }
+            else
+            {
+                sequence_state = SEQUENCE_IDLE;
+            }
+            break;
+        }
+    }
+}
+
+
+/**
+    Return whether or not a glue/press sequence is in progress
+
+    @return bool busy is true if a sequence started without blocking has not finished, else false
+*/
+bool Robot::is_busy()
+{
+    return sequence_state != SEQUENCE_IDLE;
+}
+
+
+/**
+    Abandon any glue/press sequence in progress. Modules are cancelled separately by the TaskEngine
+*/
+void Robot::cancel()
+{
+    sequence_state = SEQUENCE_IDLE;
+    coordinator->stop();
 }
 
 
@@ -199,6 +769,9 @@ void Robot::reset()
 
     //reset the laser module
     laser_module->reset();
+
+    //every motor is now stopped at its starting position, so save them in case the robot is switched off here
+    save_park();
 }
 
 
@@ -297,4 +870,168 @@ void Robot::load_offsets()
       Serial.println("ERROR: EEPROM stored value for PRESS appears to be incorrect");
       Serial.println("    Using default value: " + String(DEFAULT_PRESS_ALIGNMENT_OFFSET));
     }
-}
\ No newline at end of file
+}
+
+
+/**
+    Set the number of slots glued and then pressed at a time
+
+    @param uint8_t size is the new batch size (1 to MAX_BATCH_SIZE), or AUTO_BATCH_SIZE (0) to let the scheduler choose 
+    the batch size with the highest throughput that keeps every slot under the glue deadline
+*/
+void Robot::set_batch_size(uint8_t size)
+{
+    if (size > MAX_BATCH_SIZE)
+    {
+        Serial.println("Error: batch size " + String(size) + " is larger than the maximum batch size " + String(MAX_BATCH_SIZE));
+        return;
+    }
+    SLOT_BATCH_SIZE = size;
+    Serial.println("New SLOT_BATCH_SIZE: " + String(SLOT_BATCH_SIZE == AUTO_BATCH_SIZE ? "AUTO" : String(SLOT_BATCH_SIZE)));
+}
+
+
+/**
+    Save the SLOT_BATCH_SIZE variable to EEPROM for later reload
+*/
+void Robot::save_batch_size()
+{
+    Serial.println("Writing SLOT_BATCH_SIZE (" + String(SLOT_BATCH_SIZE) + ") to EEPROM");
+    EEPROM.put(BATCH_SIZE_ADDRESS, SLOT_BATCH_SIZE);
+}
+
+
+/**
+    Load the SLOT_BATCH_SIZE variable from EEPROM. If the value is not a valid batch size, use the default
+*/
+void Robot::load_batch_size()
+{
+    Serial.print("Loading SLOT_BATCH_SIZE from memory... ");
+    EEPROM.get(BATCH_SIZE_ADDRESS, SLOT_BATCH_SIZE);
+    Serial.println(SLOT_BATCH_SIZE);
+    if (SLOT_BATCH_SIZE > MAX_BATCH_SIZE)
+    {
+      Serial.println("ERROR: EEPROM stored value for SLOT_BATCH_SIZE appears to be incorrect");
+      Serial.println("    Using default value: " + String(DEFAULT_BATCH_SIZE));
+      SLOT_BATCH_SIZE = DEFAULT_BATCH_SIZE;
+    }
+}
+
+
+/**
+    Set the range of scale lengths (in steps, i.e. the scale length in mm times the slide's steps/mm) that detected slots 
+    are fitted to. It has to be narrower than a semitone (see BoardCatalog), so the frets detected can be identified
+
+    @param long min_scale is the shortest scale length (steps), or 0 to clear the range (so no board is identified)
+    @param long max_scale is the longest scale length (steps)
+*/
+void Robot::set_scale_range(long min_scale, long max_scale)
+{
+    if (!catalog->set_scale_range(min_scale, max_scale))
+    {
+        Serial.println("Error: scale length range " + String(min_scale) + " to " + String(max_scale) + " steps is invalid. " +
+                       "It must be at most " + String(BOARD_MAX_SCALE_RATIO, 3) + " times the shortest scale to tell the frets apart");
+        return;
+    }
+    Serial.println("New scale length range: " + String(catalog->get_min_scale()) + " to " + String(catalog->get_max_scale()) + " steps");
+}
+
+
+/**
+    Save the scale length range of the board catalog to EEPROM for later reload
+*/
+void Robot::save_scale_range()
+{
+    Serial.println("Writing scale length range (" + String(catalog->get_min_scale()) + " to " + String(catalog->get_max_scale()) + " steps) to EEPROM");
+    EEPROM.put(BOARD_SCALE_ADDRESS, catalog->get_min_scale());
+    EEPROM.put(BOARD_SCALE_ADDRESS + sizeof(long), catalog->get_max_scale());
+}
+
+
+/**
+    Load the scale length range of the board catalog from EEPROM. If it isn't a valid range, it is left unset,
+    so no board is identified until it is set
+*/
+void Robot::load_scale_range()
+{
+    long min_scale, max_scale;
+    Serial.print("Loading scale length range from memory... ");
+    EEPROM.get(BOARD_SCALE_ADDRESS, min_scale);
+    EEPROM.get(BOARD_SCALE_ADDRESS + sizeof(long), max_scale);
+    Serial.println(String(min_scale) + " to " + String(max_scale) + " steps");
+    if (!catalog->set_scale_range(min_scale, max_scale))
+    {
+        Serial.println("ERROR: EEPROM stored scale length range appears to be incorrect");
+        Serial.println("    Boards won't be identified until it is set with rf");
+        catalog->set_scale_range(0, 0);
+    }
+}
+
+
+/**
+    Save the position of every motor to EEPROM, and flag that the robot is parked cleanly.
+    Positions are only saved if every motor is calibrated, otherwise the flag is cleared
+*/
+void Robot::save_park()
+{
+    if (slide_module->motor->get_calibration_result() != 0 || glue_module->motor->get_calibration_result() != 0 || 
+        press_module->motor->get_calibration_result() != 0)
+    {
+        parked = false;
+        EEPROM.update(PARKED_ADDRESS, 0);
+        return;
+    }
+    slide_module->motor->save_home(SLIDE_HOME_ADDRESS);
+    glue_module->motor->save_home(GLUE_HOME_ADDRESS);
+    press_module->motor->save_home(PRESS_HOME_ADDRESS);
+    EEPROM.update(PARKED_ADDRESS, PARKED_CLEANLY);
+    parked = true;
+}
+
+
+/**
+    Clear the parked flag in EEPROM before any motor leaves its parked position. Only writes to EEPROM if the flag is set
+*/
+void Robot::unpark()
+{
+    if (!parked) { return; }
+    parked = false;
+    EEPROM.write(PARKED_ADDRESS, 0);
+}
+
+
+/**
+    Restore every motor position from EEPROM if the robot was parked cleanly when it was switched off.
+    The flag is cleared once read, so the saved positions are only ever trusted once.
+    The next calibration then approaches each limit at full speed, and verifies the position with a quick touch
+
+    @return bool restored is true if every motor position was restored, else false (full homing is required)
+*/
+bool Robot::load_park()
+{
+    Serial.print("Loading parked motor positions from memory... ");
+    if (EEPROM.read(PARKED_ADDRESS) != PARKED_CLEANLY)
+    {
+        Serial.println("not parked cleanly, full homing required");
+        return false;
+    }
+    Serial.println("parked cleanly");
+    EEPROM.write(PARKED_ADDRESS, 0);
+    return slide_module->motor->load_home(SLIDE_HOME_ADDRESS) & glue_module->motor->load_home(GLUE_HOME_ADDRESS) & 
+           press_module->motor->load_home(PRESS_HOME_ADDRESS);
+}
+
+
+/**
+    Return a string for the state of the robot (process settings and scheduler timing model)
+*/
+String Robot::str()
+{
+    return "Process Mode: " + String(process_mode == STREAM_MODE ? "STREAM" : process_mode == PIPELINE_MODE ? "PIPELINE" : "BATCH") +
+           "\nProcess Order: " + String(process_order == FORWARD_ORDER ? "FORWARD" : process_order == REVERSE_ORDER ? "REVERSE" : "NEAREST") +
+           "\nBatch Size: " + String(SLOT_BATCH_SIZE == AUTO_BATCH_SIZE ? "AUTO" : String(SLOT_BATCH_SIZE)) +
+           "\nDetected Slots: " + String(num_slots) +
+           "\n" + planner->str() +
+           "\n" + catalog->str() +
+           "\n" + scheduler->str();
+}
@@ -39,6 +39,11 @@
 #include "GlueModule.h"
 #include "PressModule.h"
 #include "ButtonModule.h"
+#include "SlotScheduler.h"
+#include "BoardCatalog.h"
+#include "ScanPlanner.h"
+#include "TaskEngine.h"
+#include "MotionCoordinator.h"
 
 #define PIN_LEFT_START_BUTTON 45                    //pin connected to the left start button
 #define PIN_RIGHT_START_BUTTON 47                   //pin connected to the right start button
@@ -50,24 +55,49 @@
 #define DEFAULT_PRESS_ALIGNMENT_OFFSET 13480        //default press alignment ovalue if EEPROM values are wrong
 #define PRESS_ALIGNMENT_ADDRESS 8                   //byte address of the press alignmnet offset in EEPROM
 #define EEPROM_TOLERANCE 500                        //if the value in EEPROM memory deviates more than this much, use default instead
-
-//#define DEFAULT_BATCH_SIZE 3 //use so that batch size can be updated
-#define SLOT_BATCH_SIZE 3                           //number of slots to press/glue at a time.
+#define DEFAULT_BATCH_SIZE AUTO_BATCH_SIZE          //default batch size if the EEPROM value is wrong. AUTO_BATCH_SIZE lets the scheduler tune it
+#define BATCH_SIZE_ADDRESS 16                       //byte address of the batch size in EEPROM
+#define PARKED_ADDRESS 20                           //byte address of the flag set when every motor is parked by reset() (cleared as soon as one moves)
+#define PARKED_CLEANLY 0xA5                         //value of the parked flag when the saved motor positions are valid. Anything else means they aren't
+#define SLIDE_HOME_ADDRESS 24                       //byte address of the saved slide motor position (12 bytes, see StepperModule::save_home())
+#define GLUE_HOME_ADDRESS 36                        //byte address of the saved glue motor position (12 bytes)
+#define PRESS_HOME_ADDRESS 48                       //byte address of the saved press motor position (12 bytes)
+#define BOARD_SCALE_ADDRESS 60                      //byte address of the scale length range (steps) of the boards (2 longs, 8 bytes)
+#define PIPELINE_TOLERANCE 25                       //maximum distance (steps) the glue needle may be from its slot while the slide is aligned with the press
 // #define CLIP_LOCATION 12/13 14/15                   //some way of locating the clip clamping the fretboard
 
 
 /**
 
 */
-class Robot
+class Robot : public Task
 {
 public:
+    enum process_modes
+    {
+        BATCH_MODE,                                 //glue a whole batch of slots, then press the same batch (strict lock-step)
+        PIPELINE_MODE,                              //overlap glue and press work whenever both stations line up with slots on the slide
+        STREAM_MODE                                 //glue and press slots while the laser is still scanning. Slots left over are processed as in PIPELINE_MODE
+    };
+
+    enum process_orders
+    {
+        FORWARD_ORDER,                              //glue and press from the first slot detected to the last
+        REVERSE_ORDER,                              //glue and press from the last slot detected back to the first (towards home)
+        NEAREST_ORDER                               //start from whichever end of the board is nearest the slide
+    };
+
     Robot();                                        //constructor for the PRS Guitar Fret Press Robot
-    int calibrate();                                //run all calibration process for the robot
+    int calibrate();                                //run all calibration process for the robot (every axis homes at the same time)
     int check_errors(bool laser=true,               //check how many errors occured on the robot
         bool slide=true, bool glue=true, bool press=true);
-    int detect_slots();                             //detect the locations of all frets.
+    int detect_slots();                             //detect the locations of all frets. In STREAM_MODE, also glue and press them as they are detected
     void press_frets();                             //glue and press frets into each slot
+    void start_glue_slots(int index);               //begin gluing the specified detected slot (-1 for all slots) without blocking
+    void start_press_slots(int index);              //begin pressing the specified detected slot (-1 for all slots) without blocking
+    void set_process_mode(process_modes mode);      //set the order used to glue and press frets
+    void set_process_order(process_orders order);   //set which end of the board gluing and pressing starts from
+    void set_scan_mode(scan_modes mode);            //set whether detect_slots() slows down for the whole board, or only around predicted slots
     void reset();                                   //reset the state of the robot for the next fret board
     bool start_buttons_pressed();                   //check if both start buttons are pressed
     void update_laser_offset(int delta);            //update the LASER_ALIGNMENT_OFFSET variable by delta
@@ -75,10 +105,22 @@ public:
     void update_press_offset(int delta);            //update the PRESS_ALIGNMENT_OFFSET variable by delta
     void save_offsets();                            //save the offset variables to EEPROM
     void load_offsets();                            //load the offset variables from EEPROM
+    void set_batch_size(uint8_t size);              //set the number of slots glued/pressed at a time. AUTO_BATCH_SIZE (0) to auto-tune
+    void save_batch_size();                         //save the SLOT_BATCH_SIZE variable to EEPROM
+    void load_batch_size();                         //load the SLOT_BATCH_SIZE variable from EEPROM
+    void set_scale_range(long min_scale, long max_scale);   //set the scale length range (steps) boards are identified within. 0 to clear it
+    void save_scale_range();                        //save the scale length range of the board catalog to EEPROM
+    void load_scale_range();                        //load the scale length range of the board catalog from EEPROM
+    void save_park();                               //save every motor position to EEPROM, and flag that the robot is parked cleanly
+    bool load_park();                               //restore the motor positions from EEPROM if the robot was parked cleanly when it was switched off
 
     String str();                                   //get a string for the state of the robot
     String repr();                                  //get a string of the underlying representation of the robot
 
+    void update();                                  //NEEDS TO BE CALLED ONCE PER LOOP(). Progress any glue/press sequence started without blocking
+    bool is_busy();                                 //return whether or not a glue/press sequence is in progress
+    void cancel();                                  //abandon any glue/press sequence in progress
+
     const SlideModule* slide_module;                //public read-only reference to module for slide stepper motor
     const LaserModule* laser_module;                //public read-only reference to module for laser fret sensor system
     const GlueModule* glue_module;                  //public read-only reference to module for glue application system
@@ -87,16 +129,58 @@ public:
     const ButtonModule* left_start;                 //left start button object
     const ButtonModule* right_start;                //right start button object
 
+    const SlotScheduler* scheduler;                 //public read-only reference to the scheduler planning glue/press batches
+    const BoardCatalog* catalog;                    //public read-only reference to the catalog identifying boards from their slots
+    const ScanPlanner* planner;                     //public read-only reference to the planner setting the slide speed while detecting slots
+    const TaskEngine* engine;                       //public read-only reference to the engine running every module (and the robot) concurrently
+    const MotionCoordinator* coordinator;           //public read-only reference to the coordinator for moving several motors together
+
     int32_t LASER_ALIGNMENT_OFFSET;                 //number of steps offset from slot positions to the laser axis location
     int32_t GLUE_ALIGNMENT_OFFSET;                  //number of steps offset from slot positions to the glue needle location
     int32_t PRESS_ALIGNMENT_OFFSET;                 //number of steps offset from slot positions to the press arm location
 
-    // uint8_t SLOT_BATCH_SIZE;                        //number of frets in a batch glued and pressed at a time
+    uint8_t SLOT_BATCH_SIZE;                        //number of frets in a batch glued and pressed at a time. AUTO_BATCH_SIZE (0) means auto-tune
 
 private:
     // bool has_errors();                              //check if there are any errors currently in the robot
-    long* slot_buffer;                              //handle to the list of slot positions
     int num_slots;                                  //number of slots detected
+    process_modes process_mode = PIPELINE_MODE;     //order used to glue and press frets
+    process_orders process_order = NEAREST_ORDER;   //which end of the board gluing and pressing starts from
+    bool parked = false;                            //whether the parked flag in EEPROM is set. Cleared as soon as any motor moves
+    void unpark();                                  //clear the parked flag in EEPROM, as the saved motor positions are about to become invalid
+
+    enum sequence_states
+    {
+        SEQUENCE_IDLE,                              //no glue/press sequence in progress
+        SEQUENCE_PREPARE,                           //moving the glue/press arm out of the way of the slide
+        SEQUENCE_MOVE,                              //moving the slide to align the station with the next slot
+        SEQUENCE_ACTION                             //gluing/pressing the slot at the station
+
+        //Transitions are as follows:
+        //NULL              ->  SEQUENCE_IDLE     :  on startup
+        //SEQUENCE_IDLE     ->  SEQUENCE_PREPARE  :  when start_glue_slots(-1) or start_press_slots(-1) is called
+        //SEQUENCE_IDLE     ->  SEQUENCE_MOVE     :  when start_glue_slots(index) or start_press_slots(index) is called
+        //SEQUENCE_PREPARE  ->  SEQUENCE_MOVE     :  when the station arm has finished moving
+        //SEQUENCE_MOVE     ->  SEQUENCE_ACTION   :  when the slide has finished moving. The glue pass/press operation is started
+        //SEQUENCE_ACTION   ->  SEQUENCE_MOVE     :  when the station is done, and there are more slots in the sequence
+        //SEQUENCE_ACTION   ->  SEQUENCE_IDLE     :  when the station is done with the last slot in the sequence
+        //any               ->  SEQUENCE_IDLE     :  when cancel() is called
+    };
+
+    sequence_states sequence_state = SEQUENCE_IDLE;
+    bool sequence_glue;                             //true if the sequence glues slots, false if it presses them
+    int sequence_index;                             //index of the slot currently targeted by the sequence
+    int sequence_end;                               //index one past the last slot in the sequence
+
+    bool start_sequence(int index, bool glue);      //set up a glue/press sequence over the specified slot (-1 for all slots)
+    void move_sequence_slide();                     //start moving the slide to align the sequence station with the current slot
+
+    int plan_order();                               //choose the processing order for the slots left on the current board
+    int stream_slots();                             //detect slots, and glue/press them while the laser is still scanning
+    void press_frets_batched();                     //glue and press frets in strict batches
+    void press_frets_pipelined();                   //glue and press frets, overlapping the glue and press stations where possible
+    void move_slide(long target, bool park_glue);   //move the slide to target, optionally parking the glue arm at the same time
+    void run_stations(int glue_index, int press_index, bool scanning = false); //glue and/or press the specified slots at the current slide position
 };
 
 #endif
\ No newline at end of file
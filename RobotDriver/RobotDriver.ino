@@ -44,7 +44,7 @@ Utilities* utils;
 
 void setup()
 {
-  Serial.begin(115200);
+  Serial.begin(SERIAL_BAUD);
   robot = new Robot();
   utils = new Utilities(robot);
   robot->calibrate();
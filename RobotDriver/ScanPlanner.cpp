@@ -0,0 +1,285 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    ScanPlanner.cpp
+    Purpose: Plan the slide speed while scanning a board for slots, slowing down only around predicted slots
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "ScanPlanner.h"
+
+
+/**
+    Constructor for the scan planner. Scans are UNIFORM_SCAN unless set_mode() is called
+*/
+ScanPlanner::ScanPlanner()
+{
+    mode = UNIFORM_SCAN;
+}
+
+
+/**
+    Set whether the slide slows down for the whole board, or only around predicted slots
+
+    @param scan_modes mode is UNIFORM_SCAN or ADAPTIVE_SCAN
+*/
+void ScanPlanner::set_mode(scan_modes mode)
+{
+    this->mode = mode;
+    Serial.println("Scan mode set to " + String(mode == ADAPTIVE_SCAN ? "ADAPTIVE" : "UNIFORM"));
+}
+
+
+/**
+    Return the current scan mode
+
+    @return scan_modes mode is UNIFORM_SCAN or ADAPTIVE_SCAN
+*/
+scan_modes ScanPlanner::get_mode()
+{
+    return mode;
+}
+
+
+/**
+    Set up the plan for a new board. Nothing can be predicted until slots are seen, so the slide starts at SLIDE_SCAN_SPEED
+
+    @param StepperModule* motor is the slide motor
+*/
+void ScanPlanner::start(StepperModule* motor)
+{
+    seen = 0;
+    fitted = 0;
+    next = 0;
+    misses = 0;
+    window_start = LONG_MAX;
+    window_end = LONG_MAX;
+    windows = 0;
+    restarts = 0;
+    total_misses = 0;
+
+    speed = SLIDE_SCAN_SPEED;
+    motor->set_speed(speed);
+}
+
+
+/**
+    Fold any slots detected since the last call into the prediction, skip the window if the slide has passed it 
+    without a slot, and set the speed of the slide for its current position. Call once per loop while scanning
+
+    @param long position is the current position (steps) of the slide
+    @param SlotTable* slots are the slots detected so far on the board
+    @param StepperModule* motor is the slide motor
+*/
+void ScanPlanner::update(long position, SlotTable* slots, StepperModule* motor)
+{
+    while (seen < slots->size())
+    {
+        add_slot(slots->get(seen));
+        seen++;
+    }
+
+    if (fitted >= SCAN_MIN_SLOTS && misses < SCAN_MAX_MISSES && position > window_end)
+    {
+        misses++;
+        total_misses++;
+        next++;
+        predict();
+    }
+
+    //only update the motor when the speed changes noticeably, but always slow down fully for a window
+    float target = plan_speed(position);
+    if (fabs(target - speed) >= SCAN_SPEED_RESOLUTION || (target == SLIDE_SCAN_SPEED && speed != SLIDE_SCAN_SPEED))
+    {
+        speed = target;
+        motor->set_speed(speed);
+    }
+}
+
+
+/**
+    Return the speed the slide should move at from position. Before the next window the speed is limited so the slide 
+    can still slow down to SLIDE_SCAN_SPEED by the start of the window, i.e. v^2 = SLIDE_SCAN_SPEED^2 + 2ad
+
+    @param long position is the current position (steps) of the slide
+    @return float speed is the planned speed (steps/second)
+*/
+float ScanPlanner::plan_speed(long position)
+{
+    if (mode == UNIFORM_SCAN) { return SLIDE_SCAN_SPEED; }
+    if (misses >= SCAN_MAX_MISSES) { return SLIDE_MAXIMUM_SPEED; }     //past the last fret
+    if (window_start == LONG_MAX || position >= window_start) { return SLIDE_SCAN_SPEED; }  //nothing predicted yet, or in the window
+
+    float distance = window_start - position;
+    float limit = sqrt((float) SLIDE_SCAN_SPEED * SLIDE_SCAN_SPEED + 2 * SCAN_BRAKING_MARGIN * SLIDE_DECELERATION * distance);
+    return min(limit, (float) SLIDE_MAXIMUM_SPEED);
+}
+
+
+/**
+    Return the start of the window around the next predicted slot
+
+    @return long window_start is the position (steps) the window starts at, or LONG_MAX if no slot is predicted
+*/
+long ScanPlanner::get_window_start()
+{
+    return window_start;
+}
+
+
+/**
+    Return the end of the window around the next predicted slot
+
+    @return long window_end is the position (steps) the window ends at, or LONG_MAX if no slot is predicted
+*/
+long ScanPlanner::get_window_end()
+{
+    return window_end;
+}
+
+
+/**
+    Get a string describing the last scan
+
+    @return String state is the scan mode, and how well slots were predicted
+*/
+String ScanPlanner::str()
+{
+    String state = "Scan mode: " + String(mode == ADAPTIVE_SCAN ? "ADAPTIVE" : "UNIFORM");
+    if (mode == ADAPTIVE_SCAN)
+    {
+        state += " (" + String(windows) + " windows predicted, " + String(total_misses) + " without a slot, " + String(restarts) + " restarts)";
+    }
+    return state;
+}
+
+
+/**
+    Fold a newly detected slot into the prediction. The slot is assigned to the predicted fret whose window it is in
+    (allowing for windows just missed), and the fit is updated. A slot that isn't near any predicted fret restarts the fit
+
+    @param long position is the position (steps) of the slot
+*/
+void ScanPlanner::add_slot(long position)
+{
+    if (fitted == 0) 
+    {
+        restart(position);
+        return;
+    }
+
+    int fret = next;
+    if (fitted >= SCAN_MIN_SLOTS)
+    {
+        float y = position - origin;
+        while (y > fret_position(fret) + window_width(fret) && fret < next + SCAN_MAX_MISSES) { fret++; }
+        if (fabs(y - fret_position(fret)) > window_width(fret))
+        {
+            restarts++;
+            restart(position);
+            return;
+        }
+    }
+
+    float x = pow(2, -fret / 12.0);
+    float y = position - origin;
+    sum_x += x;
+    sum_xx += x * x;
+    sum_y += y;
+    sum_xy += x * y;
+    fitted++;
+    next = fret + 1;
+    misses = 0;
+    predict();
+}
+
+
+/**
+    Start a new fit with a slot as fret 0. Nothing is predicted until SCAN_MIN_SLOTS slots are in the fit
+
+    @param long position is the position (steps) of the slot
+*/
+void ScanPlanner::restart(long position)
+{
+    origin = position;
+    sum_x = 1;                              //x = 2^0 and y = 0 for the first slot
+    sum_xx = 1;
+    sum_y = 0;
+    sum_xy = 0;
+    fitted = 1;
+    next = 1;
+    misses = 0;
+    predict();
+}
+
+
+/**
+    Set the window around the next predicted slot from the fit (or clear it if there aren't enough slots to predict from)
+*/
+void ScanPlanner::predict()
+{
+    if (fitted < SCAN_MIN_SLOTS || misses >= SCAN_MAX_MISSES)
+    {
+        window_start = LONG_MAX;
+        window_end = LONG_MAX;
+        return;
+    }
+
+    float center = origin + fret_position(next);
+    float half = window_width(next);
+    window_start = (long) (center - half);
+    window_end = (long) (center + half);
+    windows++;
+}
+
+
+/**
+    Return the predicted position of a fret from the least squares fit of y = a + b * 2^(-k/12) to the slots seen
+
+    @param int fret is the fret number, relative to the first slot of the fit
+    @return float position is the predicted position (steps) of the fret, relative to the first slot of the fit
+*/
+float ScanPlanner::fret_position(int fret)
+{
+    float n = fitted;
+    float b = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
+    float a = (sum_y - b * sum_x) / n;
+    return a + b * pow(2, -fret / 12.0);
+}
+
+
+/**
+    Return the half width of the window around a predicted fret. Fret spacing shrinks along the board (and scales with the
+    slide steps/mm), so the window is SCAN_WINDOW of the predicted spacing from the fret before, rather than a fixed distance
+
+    @param int fret is the fret number, relative to the first slot of the fit
+    @return float width is the half width (steps) of the window
+*/
+float ScanPlanner::window_width(int fret)
+{
+    return SCAN_WINDOW * fabs(fret_position(fret) - fret_position(fret - 1));
+}
@@ -0,0 +1,123 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    ScanPlanner.h
+    Purpose: Header for planning the slide speed while scanning a board for slots
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef SCAN_PLANNER_H
+#define SCAN_PLANNER_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include "SlotTable.h"
+#include "SlideModule.h"
+
+#define SCAN_WINDOW 0.1                     //half width of the window around each predicted slot that is scanned at SLIDE_SCAN_SPEED, as a fraction of the fret spacing before it
+#define SCAN_MIN_SLOTS 2                    //number of slots that must be seen before the rest are predicted (scanned at SLIDE_SCAN_SPEED until then)
+#define SCAN_MAX_MISSES 3                   //number of windows in a row without a slot before the rest of the board is scanned fast (i.e. past the last fret)
+#define SCAN_BRAKING_MARGIN 0.75            //fraction of SLIDE_DECELERATION planned on when slowing down for a window, leaving room for the S-curve
+#define SCAN_SPEED_RESOLUTION 250           //smallest change (steps/second) in the planned speed that is sent to the motor
+
+enum scan_modes
+{
+    UNIFORM_SCAN,                           //scan the whole board at SLIDE_SCAN_SPEED
+    ADAPTIVE_SCAN                           //scan at SLIDE_SCAN_SPEED around predicted slots, and at SLIDE_MAXIMUM_SPEED in between
+};
+
+
+/**
+    The ScanPlanner class sets the speed of the slide while the laser scans a board for slots.
+    Slots only take up a tiny fraction of the board, so in ADAPTIVE_SCAN the slide only slows down to SLIDE_SCAN_SPEED
+    in a window around where the next slot is expected, and runs up to SLIDE_MAXIMUM_SPEED in between.
+    Fret k after the first slot seen is at p = a + b * 2^(-k/12) for any scale length, nut position, or slide steps/mm, 
+    so a and b are refitted by least squares each time a slot is seen, and the next window is predicted from the fit.
+    The window is SCAN_WINDOW of the predicted spacing from the fret before, so it is sized in steps from the fit alone. 
+    Until SCAN_MIN_SLOTS slots have been seen there is nothing to predict from, so the start of the board is scanned slowly.
+    A slot seen outside its window means the prediction was wrong (e.g. the first fret seen was actually the second), so the 
+    fit is restarted from that slot. A window passed without a slot is skipped, and after SCAN_MAX_MISSES in a row the rest 
+    of the board is assumed to have no more slots. Slots are still detected at full speed, just with fewer samples,
+    so a bad prediction never loses a slot.
+
+    Example Usage:
+
+    ```
+    ScanPlanner* planner = new ScanPlanner();
+    planner->start();
+    slide->motor->move_relative(LONG_MAX);
+    while (!laser->done())
+    {
+        slide->motor->run();
+        laser->detect_slots(true);
+        planner->update(slide->motor->get_current_position(), laser->get_slots(), slide->motor);
+    }
+    ```
+*/
+class ScanPlanner
+{
+public:
+    //constructor for the scan planner
+    ScanPlanner();
+
+    void set_mode(scan_modes mode);         //set whether the slide slows down for the whole board, or only around predicted slots
+    scan_modes get_mode();                  //return the current scan mode
+    void start(StepperModule* motor);       //set up the plan for a new board, and set the starting speed of the slide
+    void update(long position,              //fold any new slots into the prediction, and set the speed of the slide for its current position
+        SlotTable* slots, StepperModule* motor);
+    float plan_speed(long position);        //return the speed (steps/second) the slide should move at from position
+    long get_window_start();                //return the start (steps) of the window around the next predicted slot (LONG_MAX if none)
+    long get_window_end();                  //return the end (steps) of the window around the next predicted slot (LONG_MAX if none)
+
+    String str();                           //get a string describing the last scan
+
+private:
+    scan_modes mode = UNIFORM_SCAN;         //whether to slow down for the whole board, or only around predicted slots
+    uint8_t seen = 0;                       //number of slots in the table already folded into the prediction
+    uint8_t fitted = 0;                     //number of slots in the current fit
+    int next = 0;                           //fret number (relative to the first slot of the fit) of the next predicted slot
+    uint8_t misses = 0;                     //number of windows in a row passed without a slot
+    float origin = 0;                       //position (steps) of the first slot of the fit. Positions are fitted relative to it for precision
+    float sum_x = 0;                        //least squares sums, with x = 2^(-k/12) for fret k, and y the slot position relative to origin
+    float sum_xx = 0;
+    float sum_y = 0;
+    float sum_xy = 0;
+    long window_start = LONG_MAX;           //start (steps) of the window around the next predicted slot
+    long window_end = LONG_MAX;             //end (steps) of the window around the next predicted slot
+    float speed = 0;                        //speed (steps/second) last sent to the slide motor
+    int windows = 0;                        //number of windows predicted during the scan
+    int restarts = 0;                       //number of times a slot outside its window restarted the fit
+    int total_misses = 0;                   //number of windows passed without a slot during the scan
+
+    void add_slot(long position);           //fold a newly detected slot into the prediction
+    void restart(long position);            //start a new fit from a slot
+    void predict();                         //set the window around the next predicted slot from the fit
+    float fret_position(int fret);          //return the predicted position (steps) of a fret relative to the first slot of the fit
+    float window_width(int fret);           //return the half width (steps) of the window around a predicted fret
+};
+
+#endif
@@ -39,11 +39,12 @@
 SlideModule::SlideModule()
 {
     //initialize the StepperModule object for the slide motor (read-only public reference)
-    motor = new StepperModule(PIN_SLIDE_PULSE, PIN_SLIDE_DIRECTION, PIN_SLIDE_MIN_LIMIT, PIN_SLIDE_MAX_LIMIT, "slide");
+    motor = new StepperModule(PIN_SLIDE_PULSE, PIN_SLIDE_DIRECTION, PIN_SLIDE_MIN_LIMIT, PIN_SLIDE_MAX_LIMIT, SLIDE_STEP_TIMER, "slide");
     
     //set motor speeds and accelerations
     motor->set_speeds(SLIDE_MINIMUM_SPEED, SLIDE_MEDIUM_SPEED, SLIDE_MAXIMUM_SPEED);
-    motor->set_acceleration(SLIDE_ACCELERATION);
+    motor->set_acceleration(SLIDE_ACCELERATION, SLIDE_DECELERATION);
+    motor->set_profile(S_CURVE_PROFILE, SLIDE_JERK);
 }
 
 
@@ -54,12 +55,62 @@ SlideModule::SlideModule()
 */
 int SlideModule::calibrate()
 {
-    num_errors = 0;
-    num_errors += motor->calibrate();
+    start_calibrate();
+    while (is_busy())
+    {
+        update();
+    }
     return check_errors();
 }
 
 
+/**
+    Begin calibrating the slide stepper motor step position without blocking. Progressed by update()
+*/
+void SlideModule::start_calibrate()
+{
+    num_errors = -1;                    //not calibrated until the calibration completes
+    calibrating = true;
+    motor->start_calibrate();
+}
+
+
+/**
+    Run the slide motor, and record the result of any calibration once it completes.
+    THIS NEEDS TO BE CALLED ONCE PER LOOP()
+*/
+void SlideModule::update()
+{
+    motor->run();
+    if (calibrating && !motor->is_calibrating())
+    {
+        calibrating = false;
+        num_errors = motor->get_calibration_result();
+    }
+}
+
+
+/**
+    Return whether or not the slide is moving or calibrating
+
+    @return bool busy is true if the slide is moving or calibrating, else false
+*/
+bool SlideModule::is_busy()
+{
+    return calibrating || motor->is_busy();
+}
+
+
+/**
+    Stop the slide motor, and abandon any calibration in progress
+*/
+void SlideModule::cancel()
+{
+    calibrating = false;
+    motor->cancel();
+}
+
+
 /**
     Check if any errors occured during calibration, and the module needs to be recalibrated
 */
@@ -94,5 +145,6 @@ void SlideModule::reset()
 */
 String SlideModule::str()
 {
-    return "Slide Motor Position: " + String(motor->get_current_position());
+    return "Slide Motor Position: " + String(motor->get_current_position()) +
+           "\nSlide Step Timing: " + motor->step_timing();
 }
\ No newline at end of file
@@ -36,11 +36,16 @@
 #include <Arduino.h>
 #include "StepperModule.h"
 #include "ButtonModule.h"
+#include "TaskEngine.h"
 
-#define SLIDE_MAXIMUM_SPEED 4000        //maximum speed of stepper motor (steps/second). Don't set this to more than 4000
+#define SLIDE_MAXIMUM_SPEED 16000       //maximum (cruise) speed of stepper motor (steps/second). Reached by ramping up, see SLIDE_ACCELERATION
 #define SLIDE_MEDIUM_SPEED 1000         //nominal speed of the stepper motor
+#define SLIDE_SCAN_SPEED 4000           //speed for scanning slots with the laser. Slow enough for over two ADC samples per step (see ScanPlanner)
 #define SLIDE_MINIMUM_SPEED 50          //speed for moving slowly (e.g. during calibration)
-#define SLIDE_ACCELERATION 100000       //acceleration of stepper motor (steps/second^2). Basically infinite, i.e. no ramp up/down.
+#define SLIDE_ACCELERATION 40000        //acceleration of stepper motor (steps/second^2)
+#define SLIDE_DECELERATION 40000        //deceleration of stepper motor (steps/second^2)
+#define SLIDE_JERK 400000               //maximum jerk of stepper motor (steps/second^3). The slide uses an S-curve so the fretboard doesn't shift in the clamp
+#define SLIDE_STEP_TIMER STEP_TIMER_3   //hardware timer generating the step pulses for the slide motor
 
 #define PIN_SLIDE_MIN_LIMIT 41          //pin for detecting the stepper motor is at its minimum position (i.e. x=0)
 #define PIN_SLIDE_MAX_LIMIT 43          //pin for detecting the stepper motor is at its maximum position (i.e. end of the slide)
@@ -75,16 +80,21 @@
     Note that Serial.print commands that occur every loop will make the motor motion rough.
     To counteract this, either increase the baud rate to max (115200) or disable serial communication
 */
-class SlideModule
+class SlideModule : public Task
 {
 public:
     //constructor for the slide motor module
     SlideModule();
     
     int calibrate();                                        //move the slide to the mimimum limit switch and set the position to zero
+    void start_calibrate();                                 //begin calibrating the slide without blocking
     int check_errors();
     void reset();                                           //reset the slide back to the start to prepare for the next board
 
+    void update();                                          //NEEDS TO BE CALLED ONCE PER LOOP(). Run the slide motor, and progress any calibration
+    bool is_busy();                                         //return whether or not the slide is moving or calibrating
+    void cancel();                                          //stop the slide, and abandon any calibration in progress
+
     String str();                                           //get a string describing the current state of the slide module
     String repr();                                          //get a string with the underlying representation of the slide module
 
@@ -93,6 +103,7 @@ public:
 
 private:
     int num_errors = -1;                                    //keep track of the number of errors that occured
+    bool calibrating = false;                               //whether or not a calibration is in progress
 
 };
 
@@ -0,0 +1,487 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    SlotScheduler.cpp
+    Purpose: Scheduler that plans glue/press batches around the glue open time
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "SlotScheduler.h"
+
+
+/**
+    Constructor for the slot scheduler. Starts with no slots, and the default timing model
+*/
+SlotScheduler::SlotScheduler()
+{
+    num_slots = 0;
+}
+
+
+/**
+    Create a new record for each detected slot, clearing any records from the previous board
+
+    @param SlotTable* detected is the table of slots detected by the laser
+*/
+void SlotScheduler::load(SlotTable* detected)
+{
+    int num_slots = detected->size();
+    if (num_slots > MAX_BOARD_SLOTS)
+    {
+        Serial.println("ERROR: detected " + String(num_slots) + " slots, but only " + String(MAX_BOARD_SLOTS) + " can be scheduled. Ignoring the rest");
+        num_slots = MAX_BOARD_SLOTS;
+    }
+
+    clear();
+    for (int i = 0; i < num_slots; i++)
+    {
+        add(detected->get(i));
+    }
+}
+
+
+/**
+    Clear the records from the previous board, so that slots can be added one at a time as they are detected
+*/
+void SlotScheduler::clear()
+{
+    num_slots = 0;
+    num_steps = 0;
+}
+
+
+/**
+    Create a new record for a slot that was just detected. Slots must be added in the order they are detected
+
+    @param long position is the step position of the slot
+    @return int index is the index of the new slot record, or -1 if there is no room for it
+*/
+int SlotScheduler::add(long position)
+{
+    if (num_slots >= MAX_BOARD_SLOTS) { return -1; }
+
+    slots[num_slots].position = position;
+    slots[num_slots].glue_time = 0;
+    slots[num_slots].state = SLOT_DETECTED;
+    return num_slots++;
+}
+
+
+/**
+    Return the number of slots being tracked
+
+    @return int num_slots is the number of slot records for the current board
+*/
+int SlotScheduler::get_num_slots()
+{
+    return num_slots;
+}
+
+
+/**
+    Return the record for the specified slot
+
+    @param int index is the index of the slot (from 0 to num_slots-1)
+    @return Slot* slot is a reference to the record of the slot
+*/
+Slot* SlotScheduler::get(int index)
+{
+    return &slots[index];
+}
+
+
+/**
+    Set the order that slots are processed in. Only slots that have not been glued or pressed yet are included.
+    Reverse order starts from the last slot detected, which is nearest the slide after scanning the board, 
+    and works back towards the home position
+
+    @param bool reverse is true to process slots from last to first, or false for first to last
+    @return int num_steps is the number of slots left to process
+*/
+int SlotScheduler::set_order(bool reverse)
+{
+    reverse_order = reverse;
+    num_steps = 0;
+    for (int i = 0; i < num_slots; i++)
+    {
+        int index = reverse ? num_slots - 1 - i : i;
+        if (slots[index].state == SLOT_DETECTED)
+        {
+            order[num_steps++] = index;
+        }
+    }
+    return num_steps;
+}
+
+
+/**
+    Return whether slots are processed from last to first
+
+    @return bool reverse is true if slots are processed in reverse order
+*/
+bool SlotScheduler::is_reversed()
+{
+    return reverse_order;
+}
+
+
+/**
+    Return the number of steps in the processing order, i.e. the number of slots left to process when set_order() was called
+
+    @return int num_steps is the number of processing steps
+*/
+int SlotScheduler::get_num_steps()
+{
+    return num_steps;
+}
+
+
+/**
+    Return the index of the slot processed at the specified step of the processing order
+
+    @param int step is the processing step (from 0 to get_num_steps()-1)
+    @return int index is the index of the slot processed at that step
+*/
+int SlotScheduler::slot_at(int step)
+{
+    return order[step];
+}
+
+
+/**
+    Check if a slot can be glued now while streaming (scanning, gluing and pressing in a single forward pass).
+    The slot is glued at the current slide position, and then every slot with glue waiting (including it) 
+    is pressed in position order, as the slide continues forward. Slots that are detected later are only glued 
+    if they pass the same check, so gluing this slot must not make any waiting slot miss the glue deadline
+
+    @param int index is the index of the slot under the glue needle
+    @param long slide_position is the current step position of the slide
+    @param long press_offset is the offset from slot positions to the press
+    @return bool on_time is true if every waiting slot is expected to be pressed within the deadline
+*/
+bool SlotScheduler::can_stream_glue(int index, long slide_position, long press_offset)
+{
+    unsigned long now = millis();
+    float t = glue_pass_time;                       //simulated time relative to now, after gluing this slot
+    long position = slide_position;                 //simulated slide position
+
+    for (int i = 0; i <= index; i++)                //slots are in position order, so the press visits them in index order
+    {
+        if (i != index && slots[i].state != SLOT_GLUED) { continue; }
+
+        t += hop_time(position, slots[i].position + press_offset);
+        position = slots[i].position + press_offset;
+        float glued = i == index ? 0 : -(float) (now - slots[i].glue_time);
+        if (t + press_seat_time - glued > GLUE_OPEN_TIME - GLUE_SAFETY_MARGIN) { return false; }
+        t += press_cycle_time;
+    }
+    return true;
+}
+
+
+/**
+    Record that glue was laid in a slot
+
+    @param int index is the index of the slot that was glued
+    @param unsigned long time is the time (millis) that the glue was laid
+*/
+void SlotScheduler::mark_glued(int index, unsigned long time)
+{
+    slots[index].glue_time = time;
+    slots[index].state = SLOT_GLUED;
+}
+
+
+/**
+    Record that a fret was pressed into a slot, and check whether it was pressed before the glue deadline
+
+    @param int index is the index of the slot that was pressed
+    @param unsigned long time is the time (millis) that the fret was seated in the slot
+*/
+void SlotScheduler::mark_pressed(int index, unsigned long time)
+{
+    unsigned long wait = time - slots[index].glue_time;
+    if (slots[index].state == SLOT_GLUED && wait > GLUE_OPEN_TIME)
+    {
+        slots[index].state = SLOT_LATE;
+        Serial.println("WARNING: slot " + String(index) + " pressed " + String(wait) + "ms after gluing (limit is " + String(GLUE_OPEN_TIME) + "ms)");
+    }
+    else
+    {
+        slots[index].state = SLOT_PRESSED;
+    }
+}
+
+
+/**
+    Choose the number of slots to glue and then press in the next batch.
+    When auto-tuning, every batch size that keeps each slot under the glue deadline is simulated, 
+    and the one with the highest throughput (slots per minute, including the reset between batches) is chosen.
+    Slots at the start of the batch that already have glue are always included, using their actual glue times
+
+    @param int start is the processing step of the first slot in the batch (i.e. the next slot to be pressed)
+    @param long slide_position is the current step position of the slide
+    @param long glue_offset is the offset from slot positions to the glue needle
+    @param long press_offset is the offset from slot positions to the press
+    @param (optional) uint8_t fixed_size is the batch size to use instead of auto-tuning. Default is AUTO_BATCH_SIZE (auto-tune)
+
+    @return int size is the number of slots in the batch. At least 1 if any slots remain
+*/
+int SlotScheduler::plan_batch(int start, long slide_position, long glue_offset, long press_offset, uint8_t fixed_size)
+{
+    int remaining = num_steps - start;
+    float total;                                            //total time of a simulated batch
+
+    //slots that already have glue must be pressed in this batch
+    int min_size = 1;
+    while (min_size < remaining && slots[slot_at(start + min_size)].state == SLOT_GLUED)
+    {
+        min_size++;
+    }
+    min_size = min(min_size, remaining);
+
+    if (fixed_size != AUTO_BATCH_SIZE)                      //use the fixed size, but warn if the glue is expected to dry
+    {
+        int size = constrain((int) fixed_size, min_size, remaining);
+        float wait = simulate(start, size, slide_position, glue_offset, press_offset, &total);
+        if (wait > GLUE_OPEN_TIME)
+        {
+            Serial.println("WARNING: batch of " + String(size) + " expected to wait " + String(wait, 0) + "ms between glue and press");
+        }
+        return size;
+    }
+
+    int best_size = min_size;                               //fall back to the smallest possible batch if none meet the deadline
+    float best_rate = 0;                                    //predicted slots per millisecond of the best batch
+    for (int size = min_size; size <= min(MAX_BATCH_SIZE, remaining); size++)
+    {
+        float wait = simulate(start, size, slide_position, glue_offset, press_offset, &total);
+        float rate = size / (total + BATCH_RESET_TIME);
+        if (wait <= GLUE_OPEN_TIME - GLUE_SAFETY_MARGIN && rate > best_rate)
+        {
+            best_size = size;
+            best_rate = rate;
+        }
+    }
+    return best_size;
+}
+
+
+/**
+    Update the measured time for a complete glue pass
+
+    @param unsigned long elapsed is the time (ms) the most recent glue pass took
+*/
+void SlotScheduler::record_glue(unsigned long elapsed)
+{
+    glue_pass_time += (elapsed - glue_pass_time) * TIMING_WEIGHT;
+}
+
+
+/**
+    Update the measured times for pressing a fret
+
+    @param unsigned long seat is the time (ms) from the start of the press until the fret was seated
+    @param unsigned long cycle is the time (ms) for the complete press and cut
+*/
+void SlotScheduler::record_press(unsigned long seat, unsigned long cycle)
+{
+    press_seat_time += (seat - press_seat_time) * TIMING_WEIGHT;
+    press_cycle_time += (cycle - press_cycle_time) * TIMING_WEIGHT;
+}
+
+
+/**
+    Update the measured slide travel time. Short moves are ignored, as their time is mostly fixed overhead and ramping.
+    The extra time spent ramping up and down is removed, so that the measurement is the time per step at cruise speed
+
+    @param long distance is the number of steps the slide moved
+    @param unsigned long elapsed is the time (ms) the move took
+*/
+void SlotScheduler::record_slide(long distance, unsigned long elapsed)
+{
+    distance = abs(distance);
+    if (distance < MIN_MEASURED_HOP || distance < ramp_distance()) { return; }
+
+    float overhead = SLIDE_SETTLE_TIME + 1 / (slide_step_time * slide_acceleration);
+    float step_time = (elapsed > overhead ? elapsed - overhead : 0) / distance;
+    slide_step_time += (step_time - slide_step_time) * TIMING_WEIGHT;
+}
+
+
+/**
+    Set the acceleration of the slide, used to estimate the time spent ramping up and down on each move
+
+    @param float acceleration is the slide acceleration in steps/second^2
+*/
+void SlotScheduler::set_slide_acceleration(float acceleration)
+{
+    if (acceleration > 0) { slide_acceleration = acceleration / 1e6; }
+}
+
+
+/**
+    Print any slots that missed the glue deadline on the current board
+
+    @return int num_late is the number of slots that were pressed late
+*/
+int SlotScheduler::report()
+{
+    int num_late = 0;
+    for (int i = 0; i < num_slots; i++)
+    {
+        if (slots[i].state == SLOT_LATE)
+        {
+            num_late++;
+            Serial.println("    slot " + String(i) + " at " + String(slots[i].position) + " missed the glue deadline");
+        }
+    }
+    Serial.println(String(num_late) + " of " + String(num_slots) + " slots missed the glue deadline");
+    return num_late;
+}
+
+
+/**
+    Estimate the time to move the slide between two positions.
+    Long moves cruise at full speed, and spend an extra v/a ramping up and down.
+    Short moves never reach cruise speed, and accelerate for half the distance and decelerate for the other half
+
+    @param long from is the starting step position
+    @param long to is the ending step position
+    @return float time is the estimated move time in milliseconds
+*/
+float SlotScheduler::hop_time(long from, long to)
+{
+    long distance = abs(to - from);
+    if (distance >= ramp_distance())
+    {
+        return SLIDE_SETTLE_TIME + distance * slide_step_time + 1 / (slide_step_time * slide_acceleration);
+    }
+    return SLIDE_SETTLE_TIME + 2 * sqrt(distance / slide_acceleration);
+}
+
+
+/**
+    Distance the slide travels accelerating to cruise speed and then decelerating back to a stop, i.e. v^2/a
+
+    @return float distance is the ramp distance in steps
+*/
+float SlotScheduler::ramp_distance()
+{
+    float speed = 1 / slide_step_time;
+    return speed * speed / slide_acceleration;
+}
+
+
+/**
+    Simulate gluing and then pressing a batch of slots, and return the longest time any slot waits between glue and press
+
+    @param int start is the processing step of the first slot in the batch
+    @param int size is the number of slots in the batch
+    @param long slide_position is the current step position of the slide
+    @param long glue_offset is the offset from slot positions to the glue needle
+    @param long press_offset is the offset from slot positions to the press
+    @param float* total is set to the estimated time (ms) to glue and press the whole batch
+
+    @return float wait is the estimated worst glue to press time (ms) in the batch
+*/
+float SlotScheduler::simulate(int start, int size, long slide_position, long glue_offset, long press_offset, float* total)
+{
+    unsigned long now = millis();
+    float glued[MAX_BOARD_SLOTS];                   //time each slot was (or will be) glued, relative to now
+    float t = 0;                                    //simulated time relative to now
+    long position = slide_position;                 //simulated slide position
+
+    //glue every slot in the batch that doesn't have glue yet
+    for (int i = 0; i < size; i++)
+    {
+        Slot* slot = &slots[slot_at(start + i)];
+        if (slot->state == SLOT_GLUED)
+        {
+            glued[i] = -(float) (now - slot->glue_time);
+        }
+        else
+        {
+            t += hop_time(position, slot->position + glue_offset);
+            position = slot->position + glue_offset;
+            glued[i] = t;
+            t += glue_pass_time;
+        }
+    }
+
+    //press every slot in the batch. The glue arm is moved clear of the clip during the first hop
+    float worst = 0;
+    for (int i = 0; i < size; i++)
+    {
+        Slot* slot = &slots[slot_at(start + i)];
+        float hop = hop_time(position, slot->position + press_offset);
+        t += i == 0 ? max(hop, GLUE_PARK_TIME) : hop;
+        position = slot->position + press_offset;
+        worst = max(worst, t + press_seat_time - glued[i]);
+        t += press_cycle_time;
+    }
+
+    *total = t;
+    return worst;
+}
+
+
+/**
+    Record the start time of the current board, for throughput reporting
+*/
+void SlotScheduler::start_board()
+{
+    board_start_time = millis();
+}
+
+
+/**
+    Print the throughput achieved while gluing and pressing the current board
+*/
+void SlotScheduler::finish_board()
+{
+    int num_pressed = 0;
+    for (int i = 0; i < num_slots; i++)
+    {
+        if (slots[i].state == SLOT_PRESSED || slots[i].state == SLOT_LATE) { num_pressed++; }
+    }
+
+    float minutes = (millis() - board_start_time) / 60000.0;
+    Serial.println("Pressed " + String(num_pressed) + " frets in " + String(minutes * 60, 1) + "s (" + 
+        String(minutes > 0 ? num_pressed / minutes : 0, 1) + " frets/minute)");
+}
+
+
+/**
+    Return a string describing the current timing model of the scheduler
+*/
+String SlotScheduler::str()
+{
+    return "Glue Pass: " + String(glue_pass_time, 0) + "ms" +
+           "\nPress Seat/Cycle: " + String(press_seat_time, 0) + "ms/" + String(press_cycle_time, 0) + "ms" +
+           "\nSlide Travel: " + String(slide_step_time, 3) + "ms/step";
+}
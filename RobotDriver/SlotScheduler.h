@@ -0,0 +1,148 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    SlotScheduler.h
+    Purpose: Header for the scheduler that plans glue/press batches around the glue open time
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef SLOT_SCHEDULER_H
+#define SLOT_SCHEDULER_H
+
+#include <Arduino.h>
+#include "SlotTable.h"
+
+#define MAX_BOARD_SLOTS 32                  //maximum number of slots tracked per board (boards have at most 24)
+#define MAX_BATCH_SIZE 6                    //largest number of slots that will be glued ahead of the press
+#define AUTO_BATCH_SIZE 0                   //batch size value indicating that the scheduler should choose the batch size
+#define GLUE_OPEN_TIME 25000                //maximum time (milliseconds) from glue bead down to fret pressed in the slot (see resources/glue_timeline.txt)
+#define GLUE_SAFETY_MARGIN 2000             //time (milliseconds) subtracted from GLUE_OPEN_TIME when planning, to allow for timing variation
+
+#define DEFAULT_GLUE_PASS_TIME 1500         //initial estimate of the time (milliseconds) for a complete glue pass
+#define DEFAULT_PRESS_SEAT_TIME 1700        //initial estimate of the time (milliseconds) from starting a press until the fret is seated
+#define DEFAULT_PRESS_CYCLE_TIME 5200       //initial estimate of the time (milliseconds) for a complete press and cut
+#define DEFAULT_SLIDE_STEP_TIME 0.0625      //initial estimate of the time (milliseconds) per step of slide travel at cruise speed
+#define DEFAULT_SLIDE_ACCELERATION 40000    //initial acceleration (steps/second^2) of the slide, used to estimate time spent ramping up and down
+#define SLIDE_SETTLE_TIME 20                //fixed overhead (milliseconds) for every slide move
+#define GLUE_PARK_TIME 1350                 //worst case time (milliseconds) to move the glue arm clear of the clip. Overlaps the slide hop to the first press
+#define BATCH_RESET_TIME 1400               //time (milliseconds) to reset the press and let the wire settle after each batch
+#define TIMING_WEIGHT 0.25                  //weight of each new measurement in the rolling average of measured times
+#define MIN_MEASURED_HOP 500                //slide moves shorter than this (steps), or too short to reach cruise speed, are not used to measure the slide speed
+
+
+enum slot_states
+{
+    SLOT_DETECTED,                          //slot has been detected, but has no glue yet
+    SLOT_GLUED,                             //glue has been laid in the slot, and it is waiting to be pressed
+    SLOT_PRESSED,                           //fret was pressed into the slot within GLUE_OPEN_TIME
+    SLOT_LATE                               //fret was pressed into the slot after GLUE_OPEN_TIME had passed
+};
+
+
+struct Slot                                 //record of a single slot on the board being processed
+{
+    long position;                          //step position of the slot along the slide
+    unsigned long glue_time;                //time (millis) that glue was laid in the slot
+    slot_states state;                      //current progress of the slot
+};
+
+
+/**
+    The SlotScheduler class keeps a record for every slot on the current board, and plans glue/press batches.
+    Batches are sized so that no slot waits longer than GLUE_OPEN_TIME between glue and press.
+    Slots are processed in steps, either from the first slot to the last, or in reverse (see set_order()).
+    Slots can also be added one at a time while the board is still being scanned, and glued/pressed as they stream past (see can_stream_glue()).
+    Planning uses a simple timing model (glue pass, press seat/cycle, and slide travel) that is 
+    continuously updated from measurements of the robot during production.
+    When auto-tuning, the batch size with the highest predicted frets per minute that still meets the deadline is used.
+
+    Example Usage:
+
+    ```
+    SlotScheduler* scheduler = new SlotScheduler();
+    scheduler->load(laser->get_slots());                                //create records for the detected slots
+    scheduler->set_order(false);                                        //process the slots from first to last
+
+    int batch = scheduler->plan_batch(0, slide_position, glue_offset, press_offset);
+    //<glue slots 0..batch-1, calling mark_glued() for each>
+    //<press slots 0..batch-1, calling mark_pressed() for each>
+
+    scheduler->report();                                                //print any slots that missed the deadline
+    ```
+*/
+class SlotScheduler
+{
+public:
+    //constructor for the slot scheduler
+    SlotScheduler();
+
+    void load(SlotTable* detected);                                     //create a new record for each detected slot
+    void clear();                                                       //clear the records from the previous board
+    int add(long position);                                             //create a new record for a slot as it is detected. Return its index (-1 if full)
+    int get_num_slots();                                                //return the number of slots being tracked
+    Slot* get(int index);                                               //return the record for the specified slot
+    int set_order(bool reverse);                                        //order the unprocessed slots last to first if reverse, else first to last. Return how many there are
+    bool is_reversed();                                                 //return whether slots are processed from last to first
+    int get_num_steps();                                                //return the number of steps in the processing order
+    int slot_at(int step);                                              //return the index of the slot processed at the specified step
+    bool can_stream_glue(int index, long slide_position,                //check if gluing the slot now keeps every waiting slot within the deadline while streaming
+        long press_offset);
+    void mark_glued(int index, unsigned long time);                     //record that glue was laid in the slot at time
+    void mark_pressed(int index, unsigned long time);                   //record that the slot was pressed at time, and check if it was late
+    int plan_batch(int start, long slide_position,                      //return the batch size to use starting at processing step start. Auto-tuned unless a fixed size is given
+        long glue_offset, long press_offset, uint8_t fixed_size=AUTO_BATCH_SIZE);
+    void record_glue(unsigned long elapsed);                            //update the measured glue pass time
+    void record_press(unsigned long seat, unsigned long cycle);         //update the measured press seat and cycle times
+    void record_slide(long distance, unsigned long elapsed);            //update the measured slide travel time
+    void set_slide_acceleration(float acceleration);                    //set the slide acceleration (steps/second^2) used to estimate ramp up/down time
+    int report();                                                       //print any slots that missed the deadline, and return how many did
+    void start_board();                                                 //record the start time of the current board, for throughput reporting
+    void finish_board();                                                //print the throughput achieved for the current board
+
+    String str();                                                       //get a string describing the timing model of the scheduler
+
+private:
+    Slot slots[MAX_BOARD_SLOTS];                                        //record of each slot on the board
+    int num_slots = 0;                                                  //number of slots being tracked
+    bool reverse_order = false;                                         //whether slots are processed from last to first
+    uint8_t order[MAX_BOARD_SLOTS];                                     //index of the slot processed at each step
+    int num_steps = 0;                                                  //number of steps in the processing order
+
+    float glue_pass_time = DEFAULT_GLUE_PASS_TIME;                      //measured time (ms) for a complete glue pass
+    float press_seat_time = DEFAULT_PRESS_SEAT_TIME;                    //measured time (ms) from starting a press until the fret is seated
+    float press_cycle_time = DEFAULT_PRESS_CYCLE_TIME;                  //measured time (ms) for a complete press and cut
+    float slide_step_time = DEFAULT_SLIDE_STEP_TIME;                    //measured time (ms) per step of slide travel at cruise speed
+    float slide_acceleration = DEFAULT_SLIDE_ACCELERATION / 1e6;        //acceleration of the slide (steps/ms^2)
+    unsigned long board_start_time = 0;                                 //time (millis) that processing of the current board started
+
+    float hop_time(long from, long to);                                 //estimate the time (ms) to move the slide between two positions
+    float ramp_distance();                                              //distance (steps) the slide travels ramping up to cruise speed and back down
+    float simulate(int start, int size, long slide_position,            //estimate the longest glue to press wait (ms) of a batch starting at step start, and the total time it takes
+        long glue_offset, long press_offset, float* total);
+};
+
+#endif
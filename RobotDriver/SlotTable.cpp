@@ -0,0 +1,142 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    SlotTable.cpp
+    Purpose: Class implementation for the compact table of detected slot positions
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "SlotTable.h"
+
+
+/**
+    Constructor for an empty slot table
+*/
+SlotTable::SlotTable()
+{
+    clear();
+}
+
+
+/**
+    Add a slot after the last slot in the table. Slots must be added in order along the slide, 
+    no more than MAX_SLOT_DELTA steps apart
+
+    @param float center is the step position of the center of the slot
+    @param uint8_t confidence is the confidence (0-100) in the center
+    @return bool added is false if the table is full, or the slot is before the last one or too far after it
+*/
+bool SlotTable::add(float center, uint8_t confidence)
+{
+    if (is_full()) { return false; }
+
+    long rounded = (long)floor(center + 0.5);
+    if (count == 0)
+    {
+        base = rounded;
+        last = rounded;
+    }
+    if (rounded < last || rounded - last > MAX_SLOT_DELTA) { return false; }
+
+    deltas[count] = (uint16_t)(rounded - last);
+    fractions[count] = (int8_t)constrain((center - rounded) * 256, -128, 127);
+    confidences[count] = confidence;
+    last = rounded;
+    count++;
+    return true;
+}
+
+
+/**
+    Remove every slot from the table, e.g. for a new board
+*/
+void SlotTable::clear()
+{
+    count = 0;
+    base = 0;
+    last = 0;
+}
+
+
+/**
+    Return the number of slots stored in the table
+
+    @return int size is the number of slots
+*/
+int SlotTable::size()
+{
+    return count;
+}
+
+
+/**
+    Return whether the table is full
+
+    @return bool full is true if SLOT_TABLE_CAPACITY slots are stored
+*/
+bool SlotTable::is_full()
+{
+    return count >= SLOT_TABLE_CAPACITY;
+}
+
+
+/**
+    Return the position of a slot, rounded to the nearest step
+
+    @param int index is the index of the slot (0 to size()-1)
+    @return long position is the step position of the slot
+*/
+long SlotTable::get(int index)
+{
+    long position = base;
+    for (int i = 1; i <= index; i++) { position += deltas[i]; }
+    return position;
+}
+
+
+/**
+    Return the center of a slot, with sub-step resolution
+
+    @param int index is the index of the slot (0 to size()-1)
+    @return float center is the step position of the center of the slot
+*/
+float SlotTable::get_center(int index)
+{
+    return get(index) + fractions[index] / 256.0;
+}
+
+
+/**
+    Return how confident the detection was of the center of a slot
+
+    @param int index is the index of the slot (0 to size()-1)
+    @return uint8_t confidence is from 0 (none) to 100 (full)
+*/
+uint8_t SlotTable::get_confidence(int index)
+{
+    return confidences[index];
+}
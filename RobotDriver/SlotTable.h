@@ -0,0 +1,83 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    SlotTable.h
+    Purpose: Header for the compact table of detected slot positions
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef SLOT_TABLE_H
+#define SLOT_TABLE_H
+
+#include <Arduino.h>
+
+#define SLOT_TABLE_CAPACITY 32              //maximum number of slots stored per board (boards have at most 24)
+#define MAX_SLOT_DELTA 65535                //largest distance (steps) between consecutive slots that can be stored
+
+
+/**
+    The SlotTable class stores the slots detected on a board compactly, in the order they were detected.
+    Slots are detected in order along the slide, so only the first position is stored in full. Every later slot is stored 
+    as its 16-bit distance from the one before, along with the fraction of a step to its center (1/256ths) and its 
+    confidence (0-100). That is 4 bytes per slot, instead of 6 with a full position.
+    Positions are rebuilt by summing the distances, which is cheap for the few slots on a board.
+
+    Example Usage:
+
+    ```
+    SlotTable slots;
+    slots.add(1234.5, 100);                 //add each slot as it is detected (in order along the slide)
+    slots.add(4321.25, 80);
+
+    long position = slots.get(1);           //4321 (nearest step)
+    float center = slots.get_center(1);     //4321.25
+    ```
+*/
+class SlotTable
+{
+public:
+    //constructor for an empty slot table
+    SlotTable();
+
+    bool add(float center, uint8_t confidence); //add a slot after the last one. Return false if the table is full, or the slot can't be stored
+    void clear();                           //remove every slot
+    int size();                             //return the number of slots stored
+    bool is_full();                         //return whether no more slots can be added
+    long get(int index);                    //return the position of the specified slot (rounded to the nearest step)
+    float get_center(int index);            //return the center of the specified slot, with sub-step resolution
+    uint8_t get_confidence(int index);      //return the confidence (0-100) in the center of the specified slot
+
+private:
+    long base = 0;                          //position (steps) of the first slot, rounded to the nearest step
+    long last = 0;                          //position (steps) of the last slot, rounded to the nearest step
+    uint16_t deltas[SLOT_TABLE_CAPACITY];   //distance (steps) from the previous slot to each slot. 0 for the first slot
+    int8_t fractions[SLOT_TABLE_CAPACITY];  //fraction of a step (in 1/256ths) from the rounded position to the center of each slot
+    uint8_t confidences[SLOT_TABLE_CAPACITY];   //confidence (0-100) in the center of each slot
+    uint8_t count = 0;                      //number of slots stored
+};
+
+#endif
@@ -0,0 +1,725 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    StepGenerator.cpp
+    Purpose: Interrupt driven step pulse generator used by each stepper motor
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "StepGenerator.h"
+#include <util/atomic.h>
+#include <math.h>
+
+StepGenerator* StepGenerator::generators[NUM_STEP_TIMERS] = {NULL, NULL, NULL, NULL};
+static volatile uint8_t no_pin_port = 0;        //stand in output register for generators without pins
+
+
+/**
+    Constructor for a step generator. Configures the hardware timer for CTC mode, with the clock stopped until a move starts
+
+    @param step_timers timer is the hardware timer to generate steps with. Each axis must use a different timer
+    @param uint8_t pin_pulse is the pin connected to pulse on the stepper motor driver (NO_STEP_PIN for none)
+    @param uint8_t pin_direction is the pin connected to direction on the stepper motor driver (NO_STEP_PIN for none)
+    @param (optional) bool reverse indicates whether the motor should spin in reverse. Default is false
+*/
+StepGenerator::StepGenerator(step_timers timer, uint8_t pin_pulse, uint8_t pin_direction, bool reverse)
+{
+    this->reverse = reverse;
+
+    //cache the output registers of the pins, so that the interrupt doesn't need to use digitalWrite()
+    pulse_port = direction_port = &no_pin_port;
+    pulse_mask = direction_mask = 0;
+    if (pin_pulse != NO_STEP_PIN)
+    {
+        pinMode(pin_pulse, OUTPUT);
+        pulse_port = portOutputRegister(digitalPinToPort(pin_pulse));
+        pulse_mask = digitalPinToBitMask(pin_pulse);
+    }
+    if (pin_direction != NO_STEP_PIN)
+    {
+        pinMode(pin_direction, OUTPUT);
+        direction_port = portOutputRegister(digitalPinToPort(pin_direction));
+        direction_mask = digitalPinToBitMask(pin_direction);
+    }
+
+    //configure the timer for CTC mode (count up to OCRnA, then interrupt and restart), with the clock stopped
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        switch (timer)
+        {
+            case STEP_TIMER_3:
+                timer_control = &TCCR3B; timer_count = &TCNT3; timer_compare = &OCR3A;
+                TCCR3A = 0; TIMSK3 |= (1 << OCIE3A);
+                break;
+            case STEP_TIMER_4:
+                timer_control = &TCCR4B; timer_count = &TCNT4; timer_compare = &OCR4A;
+                TCCR4A = 0; TIMSK4 |= (1 << OCIE4A);
+                break;
+            case STEP_TIMER_5:
+                timer_control = &TCCR5B; timer_count = &TCNT5; timer_compare = &OCR5A;
+                TCCR5A = 0; TIMSK5 |= (1 << OCIE5A);
+                break;
+            default:
+                timer_control = &TCCR1B; timer_count = &TCNT1; timer_compare = &OCR1A;
+                TCCR1A = 0; TIMSK1 |= (1 << OCIE1A);
+                break;
+        }
+        stop_timer();
+        write_direction(1);
+        generators[timer] = this;
+    }
+}
+
+
+/**
+    Precompute the acceleration ramp from rest up to the maximum speed.
+    The ramp is divided into RAMP_SEGMENTS segments of equal speed, and the distance along the ramp and the step interval
+    are recorded at each segment boundary. Should be called while the motor is stopped (e.g. when configuring the axis)
+
+    @param float max_speed is the top speed (steps/second) of the ramp. set_speed() above this is limited to it
+    @param float acceleration is the maximum acceleration (steps/second^2)
+    @param float deceleration is the maximum deceleration (steps/second^2) when stopping
+    @param (optional) float jerk is the maximum rate of change of acceleration (steps/second^3) for an S-curve. 
+    Default is 0, which gives a trapezoidal profile (constant acceleration)
+*/
+void StepGenerator::set_ramp(float max_speed, float acceleration, float deceleration, float jerk)
+{
+    uint16_t table[RAMP_SEGMENTS + 1];
+    uint32_t levels[RAMP_SEGMENTS + 1];
+    uint32_t slopes[RAMP_SEGMENTS];
+
+    //the ramp starts at the speed reached after the first step, and the rest of the boundaries are evenly spaced in speed
+    float start_speed = jerk > 0 ? pow(4.5 * jerk, 1.0 / 3) : sqrt(2 * acceleration);   //speed after 1 step (jerk or acceleration limited)
+    start_speed = min(start_speed, max_speed);
+    float distance = 0, speed = 0, accel = 0;           //S-curve integration state
+    for (int i = 0; i <= RAMP_SEGMENTS; i++)
+    {
+        float boundary_speed = start_speed + (max_speed - start_speed) * i / RAMP_SEGMENTS;
+        if (jerk > 0)
+        {
+            while (speed < boundary_speed)
+            {
+                advance_s_curve(&distance, &speed, &accel, max_speed, acceleration, jerk);
+            }
+        }
+        else
+        {
+            distance = boundary_speed * boundary_speed / (2 * acceleration);
+        }
+        levels[i] = i == 0 ? 0 : (uint32_t) (distance * RAMP_LEVEL_STEP);
+        table[i] = speed_interval(boundary_speed);
+    }
+    for (int i = 0; i < RAMP_SEGMENTS; i++)
+    {
+        uint32_t width = max(levels[i + 1] - levels[i], 1);
+        slopes[i] = ((uint32_t) (table[i] - table[i + 1]) << 16) / width;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (int i = 0; i <= RAMP_SEGMENTS; i++) { ramp[i] = table[i]; boundary[i] = levels[i]; }
+        for (int i = 0; i < RAMP_SEGMENTS; i++) { slope[i] = slopes[i]; }
+        level_max = levels[RAMP_SEGMENTS];
+        decel_rate = (uint16_t) constrain(RAMP_LEVEL_STEP * deceleration / acceleration, 1, 65535);
+        this->acceleration = acceleration;
+        max_stopping = level_max / decel_rate + 2;
+        level = min(level, level_max);
+        segment = 0;
+    }
+    set_speed(this->speed);                             //recompute the cruise level of the set speed on the new ramp
+}
+
+
+/**
+    Set the speed the motor moves at. The step interval and ramp level are precomputed here, so the interrupt doesn't do any math.
+    Takes effect from the next step if the motor is already moving (decelerating along the ramp if the speed was reduced)
+
+    @param float speed is the speed of the motor in steps/second
+*/
+void StepGenerator::set_speed(float speed)
+{
+    this->speed = speed;
+    uint16_t ticks_per_step = speed_interval(speed);
+    uint32_t cap = speed_level(speed);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        interval = ticks_per_step;
+        level_cap = cap;
+    }
+}
+
+
+/**
+    Return the speed the motor moves at
+
+    @return float speed is the speed of the motor in steps/second
+*/
+float StepGenerator::get_speed()
+{
+    return speed;
+}
+
+
+/**
+    Start moving towards the target position. Steps are generated in the background by the timer interrupt.
+    If the motor is already moving, the target of the current move is updated (reversing if necessary)
+
+    @param long target is the absolute step position to move to
+*/
+void StepGenerator::move_to(long target)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (coordinated) { return; }                    //the target belongs to the MotionCoordinator until the coordinated move finishes
+        this->target = target;
+        if (!running && target != position)
+        {
+            write_direction(target > position ? 1 : -1);    //set before the first step, so the driver has a full interval to register it
+            running = true;
+            start_timer();
+        }
+    }
+}
+
+
+/**
+    Immediately stop generating steps. The target is set to the current position.
+    If the axis is part of a coordinated move, the MotionCoordinator stops the rest of the axes on its next step
+*/
+void StepGenerator::stop()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        stop_timer();
+        running = false;
+        coordinated = false;
+        target = position;
+        level = 0;
+    }
+}
+
+
+/**
+    Set the current step position of the motor. Any motion is stopped
+
+    @param long position is the new step position of the motor
+*/
+void StepGenerator::set_position(long position)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        stop_timer();
+        running = false;
+        coordinated = false;
+        this->position = position;
+        target = position;
+        level = 0;
+    }
+}
+
+
+/**
+    Return the current step position of the motor
+
+    @return long position is the current step position
+*/
+long StepGenerator::get_position()
+{
+    long current;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        current = position;
+    }
+    return current;
+}
+
+
+/**
+    Return the position counter that the step interrupt updates. Interrupts don't nest, so another interrupt 
+    (e.g. the ADC interrupt of an AnalogSampler) can read it directly, but the foreground must use get_position()
+
+    @return const volatile long* position is the step position of the motor
+*/
+const volatile long* StepGenerator::get_position_register()
+{
+    return &position;
+}
+
+
+/**
+    Return the target position of the current move
+
+    @return long target is the target step position
+*/
+long StepGenerator::get_target()
+{
+    long current;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        current = target;
+    }
+    return current;
+}
+
+
+/**
+    Return the number of steps to the target
+
+    @return long distance is the number of steps to the target. Sign indicates direction of travel
+*/
+long StepGenerator::get_distance()
+{
+    long distance;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        distance = target - position;
+    }
+    return distance;
+}
+
+
+/**
+    Return whether or not steps are being generated
+
+    @return bool running is true if the motor is moving, else false
+*/
+bool StepGenerator::is_running()
+{
+    return running;
+}
+
+
+/**
+    Attach limit switches to the motor. The switch in the direction of travel is checked by the interrupt before every step,
+    and stops the motor as soon as it has been pressed for LIMIT_DEBOUNCE_SAMPLES steps in a row.
+    The pins should already be configured as inputs (e.g. by a ButtonModule)
+
+    @param uint8_t pin_min is the pin of the minimum limit switch (NO_STEP_PIN for none)
+    @param uint8_t pin_max is the pin of the maximum limit switch (NO_STEP_PIN for none)
+*/
+void StepGenerator::set_limits(uint8_t pin_min, uint8_t pin_max)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        min_port = pin_min == NO_STEP_PIN ? NULL : portInputRegister(digitalPinToPort(pin_min));
+        min_mask = pin_min == NO_STEP_PIN ? 0 : digitalPinToBitMask(pin_min);
+        max_port = pin_max == NO_STEP_PIN ? NULL : portInputRegister(digitalPinToPort(pin_max));
+        max_mask = pin_max == NO_STEP_PIN ? 0 : digitalPinToBitMask(pin_max);
+        limit_count = 0;
+    }
+}
+
+
+/**
+    Return which limit switch (if any) stopped the motor, and clear it so that each limit stop is only reported once
+
+    @return int8_t limit is -1 if the minimum limit stopped the motor, 1 if the maximum limit did, or 0 if neither has since the last call
+*/
+int8_t StepGenerator::take_limit_hit()
+{
+    int8_t hit;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        hit = limit_hit;
+        limit_hit = 0;
+    }
+    return hit;
+}
+
+
+/**
+    Return the most timer ticks (0.5us each) from a step being due to the end of its interrupt, and clear it. This is the worst 
+    time other interrupts delayed the step plus the time the step took, so MIN_STEP_INTERVAL should stay well above it
+
+    @return uint16_t latency is the worst latency (timer ticks) since the last call
+*/
+uint16_t StepGenerator::take_max_latency()
+{
+    uint16_t latency;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        latency = max_latency;
+        max_latency = 0;
+    }
+    return latency;
+}
+
+
+/**
+    Return the number of steps whose interrupt finished after the next step was due (which were then taken late), and clear it
+
+    @return unsigned int late is the number of late steps since the last call
+*/
+unsigned int StepGenerator::take_late_steps()
+{
+    unsigned int late;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        late = late_steps;
+        late_steps = 0;
+    }
+    return late;
+}
+
+
+/**
+    Generate the next step for the axis attached to the specified timer. Called from the timer compare interrupts
+
+    @param step_timers timer is the timer whose compare interrupt fired
+*/
+void StepGenerator::handle_interrupt(step_timers timer)
+{
+    if (generators[timer] != NULL)
+    {
+        generators[timer]->step();
+    }
+}
+
+
+/**
+    Generate a single step towards the target, following the acceleration ramp, and stop the timer once the target is reached.
+    The motor decelerates once the remaining distance is within its stopping distance. If the target is moved behind 
+    the motor (or too close to stop in time), it decelerates to rest, changes direction, and waits an interval before stepping back.
+    RUNS IN THE TIMER INTERRUPT, so only integer math is used
+*/
+void StepGenerator::step()
+{
+    if (check_limit()) { return; }                      //stopped at a limit switch
+
+    long remaining = (target - position) * direction;  //steps left in the direction of travel. Negative if the target is behind
+    if (remaining == 0 && level <= decel_rate)          //arrived at the target
+    {
+        stop_timer();
+        running = false;
+        level = 0;
+        return;
+    }
+
+    //climb or descend the ramp. Stopping distance is level/decel_rate, but is checked by multiplying to avoid dividing here
+    bool stopping = remaining <= 0 || ((uint32_t) remaining < max_stopping && (uint32_t) remaining * decel_rate <= level);
+    if (stopping || level > level_cap)                  //decelerate to stop at the target, or down to a reduced speed
+    {
+        level = level > decel_rate ? level - decel_rate : 0;
+    }
+    else if (level < level_cap)                         //accelerate towards the set speed
+    {
+        level = min(level + RAMP_LEVEL_STEP, level_cap);
+    }
+
+    if (remaining < 0 && level == 0)                    //at rest past the target. Change direction, and wait an interval before stepping
+    {
+        write_direction(-direction);
+        *timer_compare = ramp_interval(0);
+        catch_up();
+        return;
+    }
+
+    //raise the step pin straight away, and lower it after the rest of the step is computed, instead of waiting out the pulse
+    uint16_t pulse_start = *timer_count;
+    begin_pulse();
+    position += direction;
+    *timer_compare = ramp_interval(level);              //interval until the next step
+    bool arrived = position == target && level <= decel_rate;
+    if (arrived)                                        //reached the target
+    {
+        running = false;
+        level = 0;
+    }
+    hold_pulse(pulse_start);
+    end_pulse();
+    if (arrived) { stop_timer(); }                      //the timer is only stopped once the pulse is done, as the pulse is timed by it
+    else { catch_up(); }
+}
+
+
+/**
+    Read the limit switch in the direction of travel, and stop the motor (latching which limit it was) once it has read 
+    as pressed LIMIT_DEBOUNCE_SAMPLES times in a row. Any reading of unpressed resets the count, so noise doesn't stop the motor.
+    RUNS IN THE TIMER INTERRUPT
+
+    @return bool stopped is true if the motor was stopped at the limit, else false
+*/
+bool StepGenerator::check_limit()
+{
+    volatile uint8_t* port = direction > 0 ? max_port : min_port;
+    uint8_t mask = direction > 0 ? max_mask : min_mask;
+    if (port == NULL || !(*port & mask))
+    {
+        limit_count = 0;
+        return false;
+    }
+    if (++limit_count < LIMIT_DEBOUNCE_SAMPLES) { return false; }
+
+    stop_timer();
+    running = false;
+    coordinated = false;
+    target = position;
+    level = 0;
+    limit_count = 0;
+    limit_hit = direction;
+    return true;
+}
+
+
+/**
+    Begin the step pulse of the motor driver.
+    RUNS IN THE TIMER INTERRUPT
+*/
+void StepGenerator::begin_pulse()
+{
+    *pulse_port |= pulse_mask;
+}
+
+
+/**
+    End the step pulse of the motor driver.
+    RUNS IN THE TIMER INTERRUPT
+*/
+void StepGenerator::end_pulse()
+{
+    *pulse_port &= ~pulse_mask;
+}
+
+
+/**
+    Wait until the step pulse is at least STEP_PULSE_TICKS wide. The rest of the step usually takes longer than that, 
+    so this rarely spins. If the timer was stopped during the step (i.e. a coordinated move was aborted), 
+    the count is frozen, so a fixed delay is used instead.
+    RUNS IN THE TIMER INTERRUPT
+
+    @param uint16_t start is the timer count when the pulse was raised
+*/
+void StepGenerator::hold_pulse(uint16_t start)
+{
+    if (!(*timer_control & (1 << CS31)))
+    {
+        delayMicroseconds(STEP_PULSE_WIDTH);
+        return;
+    }
+    while ((uint16_t) (*timer_count - start) < STEP_PULSE_TICKS) {}   //a count that wrapped at the compare match has waited long enough
+}
+
+
+/**
+    Record how long after its compare match the step interrupt finished, and make sure the next compare match isn't missed.
+    In CTC mode the count restarts at each compare match, so it is the time since the step was due (including any time spent
+    waiting behind other interrupts). If it has already passed the new compare value, the match would be missed, and the timer 
+    would run on to 0xFFFF and wrap (a ~32ms stall mid-move). Instead the count is moved up to just before the compare value, 
+    so the late step is taken STEP_CATCH_UP_TICKS from now. Called last in the step, once the compare value is written.
+    RUNS IN THE TIMER INTERRUPT
+*/
+void StepGenerator::catch_up()
+{
+    if (!(*timer_control & (1 << CS31))) { return; }   //the timer was stopped during the step (i.e. a coordinated move was aborted)
+
+    uint16_t count = *timer_count;
+    uint16_t compare = *timer_compare;
+    if (count > max_latency) { max_latency = count; }
+    if (count > compare)
+    {
+        *timer_count = compare - STEP_CATCH_UP_TICKS;
+        late_steps++;
+    }
+}
+
+
+/**
+    Return the step interval at a level of the acceleration ramp, interpolated within the segment the level is in.
+    The current segment is tracked between calls, since the level only changes by a little each step.
+    The interval is never shorter than the interval of the set speed
+
+    @param uint32_t level is the distance along the ramp (1/256 steps)
+    @return uint16_t interval is the step interval in timer ticks
+*/
+uint16_t StepGenerator::ramp_interval(uint32_t level)
+{
+    if (level_max == 0) { return interval; }            //no ramp, so always move at the set speed
+
+    while (segment < RAMP_SEGMENTS && level >= boundary[segment + 1]) { segment++; }
+    while (segment > 0 && level < boundary[segment]) { segment--; }
+
+    uint16_t ticks = ramp[RAMP_SEGMENTS];
+    if (segment < RAMP_SEGMENTS)
+    {
+        ticks = ramp[segment] - (uint16_t) (((level - boundary[segment]) * slope[segment]) >> 16);
+    }
+    return max(ticks, interval);
+}
+
+
+/**
+    Find the level of the acceleration ramp where the motor reaches the specified speed
+
+    @param float speed is the speed in steps/second
+    @return uint32_t level is the distance along the ramp (1/256 steps). 0 if the motor can start at this speed
+*/
+uint32_t StepGenerator::speed_level(float speed)
+{
+    if (level_max == 0) { return 0; }
+
+    uint16_t ticks = speed_interval(speed);
+    if (ticks >= ramp[0]) { return 0; }                 //slow enough to start instantly
+    for (int i = 0; i < RAMP_SEGMENTS; i++)
+    {
+        if (ticks >= ramp[i + 1])                       //speed is reached within this segment
+        {
+            uint32_t offset = slope[i] > 0 ? ((uint32_t) (ramp[i] - ticks) << 16) / slope[i] : 0;
+            return min(boundary[i] + offset, level_max);
+        }
+    }
+    return level_max;                                   //faster than the ramp goes, so cruise at the top
+}
+
+
+/**
+    Convert a speed to a step interval, limited to what the timer can generate
+
+    @param float speed is the speed in steps/second
+    @return uint16_t interval is the step interval in timer ticks
+*/
+uint16_t StepGenerator::speed_interval(float speed)
+{
+    float ticks = speed > 0 ? STEP_TICKS_PER_SECOND / speed : MAX_STEP_INTERVAL;
+    return (uint16_t) constrain(ticks, MIN_STEP_INTERVAL, MAX_STEP_INTERVAL);
+}
+
+
+/**
+    Copy the acceleration ramp of another generator, rescaled for an axis that moves ratio times as many steps in the same time.
+    The ramp keeps the same shape in time (so the source axis stays within its limits), but covers ratio times the distance at
+    ratio times the speed. Only a little math per segment is needed, so this is fast enough to do before every coordinated move
+
+    @param StepGenerator* source is the generator whose ramp should be followed
+    @param float ratio is the number of steps this axis moves for each step of the source axis (at least 1)
+*/
+void StepGenerator::scale_ramp(StepGenerator* source, float ratio)
+{
+    uint16_t table[RAMP_SEGMENTS + 1];
+    uint32_t levels[RAMP_SEGMENTS + 1];
+    uint32_t slopes[RAMP_SEGMENTS];
+
+    for (int i = 0; i <= RAMP_SEGMENTS; i++)
+    {
+        table[i] = (uint16_t) max(source->ramp[i] / ratio, MIN_STEP_INTERVAL);
+        levels[i] = (uint32_t) (source->boundary[i] * ratio);
+    }
+    for (int i = 0; i < RAMP_SEGMENTS; i++)
+    {
+        uint32_t width = max(levels[i + 1] - levels[i], 1);
+        slopes[i] = ((uint32_t) (table[i] - table[i + 1]) << 16) / width;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (int i = 0; i <= RAMP_SEGMENTS; i++) { ramp[i] = table[i]; boundary[i] = levels[i]; }
+        for (int i = 0; i < RAMP_SEGMENTS; i++) { slope[i] = slopes[i]; }
+        level_max = source->level_max == 0 ? 0 : max(levels[RAMP_SEGMENTS], 1);
+        decel_rate = source->decel_rate;
+        max_stopping = level_max / decel_rate + 2;
+        acceleration = source->acceleration * ratio;
+        level = min(level, level_max);
+        segment = 0;
+    }
+    set_speed(this->speed);
+}
+
+
+/**
+    Integrate a jerk limited S-curve from rest by one time step (S_CURVE_TIME_STEP).
+    Acceleration rises at the jerk limit up to the maximum acceleration, and falls again at the jerk limit 
+    so that it reaches zero just as the speed reaches the maximum speed
+
+    @param float* distance is the distance travelled (steps). Updated
+    @param float* speed is the current speed (steps/second). Updated
+    @param float* acceleration is the current acceleration (steps/second^2). Updated
+    @param float max_speed is the speed (steps/second) at the end of the curve
+    @param float max_acceleration is the acceleration limit (steps/second^2)
+    @param float jerk is the jerk limit (steps/second^3)
+*/
+void StepGenerator::advance_s_curve(float* distance, float* speed, float* acceleration, float max_speed, float max_acceleration, float jerk)
+{
+    float dt = S_CURVE_TIME_STEP;
+    if (*speed + *acceleration * *acceleration / (2 * jerk) >= max_speed)  //time to ease off, so acceleration reaches 0 at max_speed
+    {
+        *acceleration = max(*acceleration - jerk * dt, 0);
+        if (*acceleration == 0) { *speed = max_speed; }                     //reached the top of the curve
+    }
+    else
+    {
+        *acceleration = min(*acceleration + jerk * dt, max_acceleration);
+    }
+    *speed = min(*speed + *acceleration * dt, max_speed);
+    *distance += *speed * dt;
+}
+
+
+/**
+    Set the direction pin for the specified direction of travel. 
+    Must be called with interrupts disabled, as the pulse pin may share the same port
+
+    @param int8_t direction is 1 for forward, or -1 for backward
+*/
+void StepGenerator::write_direction(int8_t direction)
+{
+    this->direction = direction;
+    if ((direction > 0) != reverse)
+    {
+        *direction_port |= direction_mask;
+    }
+    else
+    {
+        *direction_port &= ~direction_mask;
+    }
+}
+
+
+/**
+    Start the timer clock, with the first step one interval from now
+*/
+void StepGenerator::start_timer()
+{
+    *timer_count = 0;
+    *timer_compare = ramp_interval(level);
+    *timer_control = (1 << WGM32) | (1 << CS31);        //CTC mode, clock/8 (WGMn2 and CSn1 are the same bits on Timer1/3/4/5)
+}
+
+
+/**
+    Stop the timer clock. The timer stays in CTC mode
+*/
+void StepGenerator::stop_timer()
+{
+    *timer_control = (1 << WGM32);
+}
+
+
+//timer compare interrupts. Each generates the next step for its axis
+ISR(TIMER3_COMPA_vect) { StepGenerator::handle_interrupt(STEP_TIMER_3); }
+ISR(TIMER4_COMPA_vect) { StepGenerator::handle_interrupt(STEP_TIMER_4); }
+ISR(TIMER5_COMPA_vect) { StepGenerator::handle_interrupt(STEP_TIMER_5); }
+ISR(TIMER1_COMPA_vect) { StepGenerator::handle_interrupt(STEP_TIMER_1); }
@@ -0,0 +1,190 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    StepGenerator.h
+    Purpose: Header for the interrupt driven step pulse generator used by each stepper motor
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef STEP_GENERATOR_H
+#define STEP_GENERATOR_H
+
+#include <Arduino.h>
+
+#define STEP_TIMER_PRESCALER 8                  //hardware timer clock divider. 16MHz/8 gives 0.5us timer ticks
+#define STEP_TICKS_PER_SECOND (F_CPU / STEP_TIMER_PRESCALER)    //number of timer ticks per second
+#define MIN_STEP_INTERVAL 100                   //shortest step interval (timer ticks) allowed, i.e. 20000 steps/second. Twice the estimated worst step() time (~400 cycles), so one axis at full rate uses at most half the CPU
+#define MAX_STEP_INTERVAL 65535                 //longest step interval (timer ticks) the 16-bit timers can count, i.e. ~31 steps/second
+#define STEP_PULSE_WIDTH 2                      //minimum width (microseconds) of a step pulse for the stepper drivers
+#define STEP_PULSE_TICKS (STEP_PULSE_WIDTH * (STEP_TICKS_PER_SECOND / 1000000))  //minimum width of a step pulse in timer ticks
+#define STEP_CATCH_UP_TICKS 2                   //timer ticks until a late step is taken. Writing the count blocks a compare match on the next tick, so this must be at least 2
+#define RAMP_SEGMENTS 24                        //number of equal speed segments the precomputed acceleration ramp is divided into (the table has one more entry)
+#define RAMP_LEVEL_STEP 256                     //ramp level gained per step while accelerating. Ramp levels are in 1/256ths of a step along the ramp
+#define S_CURVE_TIME_STEP 0.0005                //time step (seconds) used to integrate jerk limited S-curves when building the ramp
+#define NO_STEP_PIN 0xFF                        //pin number for a generator that doesn't drive any pins (i.e. the MotionCoordinator)
+#define LIMIT_DEBOUNCE_SAMPLES 3                //consecutive pressed readings (one per step) before a limit switch stops the motor
+
+enum step_timers
+{
+    STEP_TIMER_3,                               //16-bit Timer3
+    STEP_TIMER_4,                               //16-bit Timer4
+    STEP_TIMER_5,                               //16-bit Timer5
+    STEP_TIMER_1,                               //16-bit Timer1. Used by the MotionCoordinator to step several axes together
+    NUM_STEP_TIMERS                             //number of timers available for step generation (Timer0 is used by millis())
+};
+
+
+/**
+    The StepGenerator class produces the step pulses for a single stepper motor from a hardware timer interrupt.
+    Each axis owns one of the Mega's free 16-bit timers, running in CTC mode. The compare interrupt fires once 
+    per step, so the step rate is exact, and independent of how fast the main loop runs (e.g. during analogRead(),
+    serial printing or HX711 reads). The step interval (in timer ticks) is precomputed whenever the speed is set,
+    so the interrupt only has to pulse the step pin, and count the position.
+
+    Acceleration follows a ramp table precomputed by set_ramp(), which divides the ramp from rest up to the maximum speed
+    into segments of equal speed, and holds the distance along the ramp and the step interval at each segment boundary.
+    The ramp can be trapezoidal (constant acceleration) or a jerk limited S-curve. While moving, the interrupt tracks its 
+    "level" (distance along the ramp), climbing the ramp until the set speed is reached, and descending it (scaled by 
+    the deceleration) when it needs to stop at the target. The step interval is interpolated within the current segment
+    using a precomputed slope, so only integer multiplication (no division) is done in the interrupt.
+    Short moves that never reach the set speed get a triangular (time-optimal) profile automatically.
+
+    A generator can also be driven by a MotionCoordinator instead of its own timer, so that it starts and finishes 
+    a move together with other axes. While coordinated, move_to() is ignored, but stop() still stops the axis.
+
+    If limit switches are attached with set_limits(), the switch in the direction of travel is read (straight from its
+    input register) before every step, and debounced by requiring LIMIT_DEBOUNCE_SAMPLES pressed readings in a row.
+    When it trips, the interrupt stops the motor on the spot, and latches which limit was hit for take_limit_hit().
+    The limit pins on the Mega (33-43) don't support pin change interrupts, so they are sampled by the step interrupt instead,
+    which also means the motor never moves more than LIMIT_DEBOUNCE_SAMPLES steps into a pressed switch, at any speed.
+
+    Example Usage:
+
+    ```
+    StepGenerator* generator = new StepGenerator(STEP_TIMER_3, 3, 2);  //generate steps for the motor on pins 3 (pulse) and 2 (direction)
+    
+    setup()
+    {
+        generator->set_ramp(16000, 40000, 40000);   //ramp up to 16000 steps/second at 40000 steps/second^2
+        generator->set_speed(4000);         //steps/second
+        generator->move_to(10000);          //start moving. Steps are generated in the background
+    }
+
+    loop()
+    {
+        if (!generator->is_running()) { Serial.println(generator->get_position()); }
+    }
+    ```
+*/
+class StepGenerator
+{
+    friend class MotionCoordinator;             //the coordinator steps other generators directly from its own interrupt
+
+public:
+    //constructor for a step generator on the specified hardware timer, driving the specified pulse/direction pins
+    StepGenerator(step_timers timer, uint8_t pin_pulse, uint8_t pin_direction, bool reverse=false);
+
+    void set_ramp(float max_speed, float acceleration,  //precompute the acceleration ramp. jerk=0 gives a trapezoidal profile, else a jerk limited S-curve
+        float deceleration, float jerk=0);
+    void set_speed(float speed);                //set the speed (steps/second) the motor moves at
+    float get_speed();                          //return the speed (steps/second) the motor moves at
+    void move_to(long target);                  //start moving towards the target position (or update the target of the current move)
+    void stop();                                //immediately stop generating steps, and set the target to the current position
+    void set_position(long position);           //set the current step position of the motor (stops any motion)
+    long get_position();                        //return the current step position of the motor
+    const volatile long* get_position_register();   //return the position updated by the interrupt, for reading from other interrupts
+    long get_target();                          //return the current target position of the motor
+    long get_distance();                        //return the number of steps to the target. Sign indicates direction
+    bool is_running();                          //return whether or not steps are being generated
+    void set_limits(uint8_t pin_min, uint8_t pin_max);  //attach limit switches (HIGH when pressed) that stop the motor from the interrupt
+    int8_t take_limit_hit();                    //return (and clear) which limit stopped the motor. -1 for min, 1 for max, 0 for none
+    uint16_t take_max_latency();                //return (and clear) the most timer ticks from a step being due to its interrupt finishing
+    unsigned int take_late_steps();             //return (and clear) the number of steps whose interrupt finished after the next step was due
+
+    static void handle_interrupt(step_timers timer);    //called by the timer compare interrupts. Generate the next step for the axis on that timer
+
+protected:
+    virtual void begin_pulse();                 //raise the step pin. Called from the interrupt as soon as the motor is going to step
+    virtual void end_pulse();                   //lower the step pin. Called from the interrupt once the rest of the step is done
+
+private:
+    volatile long position = 0;                 //current step position of the motor. Updated by the interrupt
+    volatile long target = 0;                   //target step position of the motor
+    volatile int8_t direction = 1;              //direction the direction pin is currently set to (1 or -1)
+    volatile bool running = false;              //whether or not the timer (or a coordinator) is generating steps
+    volatile bool coordinated = false;          //whether or not the steps are being generated by a MotionCoordinator
+    volatile uint16_t interval = MAX_STEP_INTERVAL;    //precomputed step interval (timer ticks) for the current speed
+    float speed = 0;                            //current speed (steps/second)
+    float acceleration = 0;                     //acceleration (steps/second^2) of the ramp. 0 means no ramp
+
+    volatile uint32_t level = 0;                //current distance along the acceleration ramp (1/256 steps). 0 means at rest
+    volatile uint32_t level_cap = 0;            //ramp level of the set speed, where the motor cruises
+    uint16_t ramp[RAMP_SEGMENTS + 1];           //step interval (timer ticks) at each segment boundary of the acceleration ramp
+    uint32_t boundary[RAMP_SEGMENTS + 1];       //ramp level at each segment boundary
+    uint32_t slope[RAMP_SEGMENTS];              //decrease in step interval per level within each segment (16.16 fixed point)
+    volatile uint8_t segment = 0;               //segment of the ramp the current level is in
+    uint32_t level_max = 0;                     //ramp level at the top of the ramp. 0 means no ramp (moves start at full speed)
+    uint16_t decel_rate = RAMP_LEVEL_STEP;      //ramp level lost per step while decelerating (scaled by deceleration/acceleration)
+    uint32_t max_stopping = 0;                  //more than the number of steps needed to stop from the top of the ramp
+    bool reverse;                               //whether the direction pin is inverted
+
+    volatile uint8_t* pulse_port;               //output register of the pulse pin
+    uint8_t pulse_mask;                         //bit of the pulse pin in its output register
+    volatile uint8_t* direction_port;           //output register of the direction pin
+    uint8_t direction_mask;                     //bit of the direction pin in its output register
+
+    volatile uint8_t* min_port = NULL;          //input register of the minimum limit switch pin. NULL if there is no switch
+    uint8_t min_mask = 0;                       //bit of the minimum limit switch pin in its input register
+    volatile uint8_t* max_port = NULL;          //input register of the maximum limit switch pin. NULL if there is no switch
+    uint8_t max_mask = 0;                       //bit of the maximum limit switch pin in its input register
+    volatile uint8_t limit_count = 0;           //number of pressed readings in a row of the limit in the direction of travel
+    volatile int8_t limit_hit = 0;              //latched limit that stopped the motor. -1 for min, 1 for max, 0 for none
+    volatile uint16_t max_latency = 0;          //most timer ticks from a compare match to the end of its step interrupt, since take_max_latency()
+    volatile unsigned int late_steps = 0;       //number of steps whose interrupt finished after the next compare value, since take_late_steps()
+
+    volatile uint8_t* timer_control;            //TCCRnB control register of the timer (starts/stops the clock)
+    volatile uint16_t* timer_count;             //TCNTn count register of the timer
+    volatile uint16_t* timer_compare;           //OCRnA compare register of the timer (the step interval)
+
+    static StepGenerator* generators[NUM_STEP_TIMERS];  //generator attached to each timer, for dispatching interrupts
+
+    void step();                                //generate the next step towards the target. Called from the interrupt
+    bool check_limit();                         //read the limit in the direction of travel, and stop the motor if it has tripped. Called from the interrupt
+    uint16_t ramp_interval(uint32_t level);     //return the step interval (timer ticks) at a level of the ramp (updating the current segment), limited by the set speed
+    uint32_t speed_level(float speed);          //return the ramp level where the motor reaches the specified speed
+    static uint16_t speed_interval(float speed);    //convert a speed (steps/second) to a step interval (timer ticks)
+    void scale_ramp(StepGenerator* source, float ratio);    //copy the ramp of another generator, for an axis that moves ratio times as many steps
+    static void advance_s_curve(float* distance, float* speed, float* acceleration, //integrate an S-curve from rest by one time step
+        float max_speed, float max_acceleration, float jerk);
+    void hold_pulse(uint16_t start);            //wait until the step pulse raised at the timer count start is at least STEP_PULSE_TICKS wide
+    void catch_up();                            //record the interrupt latency, and if the count already passed the compare value, take the next step straight away
+    void write_direction(int8_t direction);     //set the direction pin for the specified direction of travel
+    void start_timer();                         //start the timer, with the first step one interval from now
+    void stop_timer();                          //stop the timer clock
+};
+
+#endif
@@ -32,6 +32,7 @@
 
 #include "StepperModule.h"
 #include <limits.h>
+#include <EEPROM.h>
 
 /**
     Constructor for stepper module
@@ -40,25 +41,24 @@
     @param uint8_t pin_direction is the pin connected to direction on the stepper motor driver
     @param uint8_t pin_min_limit is the pin connected to the minimum limit switch for this motor
     @param uint8_t pin_max_limit is the pin connected to the maximum limit switch for this motor
+    @param step_timers timer is the hardware timer used to generate step pulses. Each motor must use a different timer
     @param String name is the name of the stepper motor, e.g. "slide", "glue", or "press".
     @param (optional) bool reverse indicates whether the motor should spin in reverse. Default is false
 */
-StepperModule::StepperModule(uint8_t pin_pulse, uint8_t pin_direction, uint8_t pin_min_limit, uint8_t pin_max_limit, String name, bool reverse)
+StepperModule::StepperModule(uint8_t pin_pulse, uint8_t pin_direction, uint8_t pin_min_limit, uint8_t pin_max_limit, step_timers timer, String name, bool reverse)
 {
-    //create new stepper motor object, and set the speed to the default
-    motor = new AccelStepper(AccelStepper::DRIVER, pin_pulse, pin_direction);
+    //create new step generator for the motor (reversing the direction if specified), and set the speed to the default
+    motor = new StepGenerator(timer, pin_pulse, pin_direction, reverse);
     set_speed(STEPPER_MAXIMUM_SPEED);
+    update_ramp();
 
     //initialize limit switches for the motor
     min_limit = new ButtonModule(pin_min_limit);
     max_limit = new ButtonModule(pin_max_limit);
+    motor->set_limits(pin_min_limit, pin_max_limit);   //the step interrupt stops the motor at the limit in the direction of travel
 
     //set the name of this stepper motor. Should be either "slide", "glue", or "press"
     this->name = String(name);
-
-    //reverse the direction of the stepper motor if specified
-    motor->setPinsInverted(reverse);
-    
 }
 
 
@@ -69,49 +69,351 @@ StepperModule::StepperModule(uint8_t pin_pulse, uint8_t pin_direction, uint8_t p
 */
 int StepperModule::calibrate()
 {
-    //slide the motor back until it presses the button
+    start_calibrate();
+    while (is_calibrating())
+    {
+        run();
+    }
+    return calibration_result;
+}
+
+
+/**
+    Begin homing the motor without blocking. Calibration is progressed each time run() is called.
+    Use is_calibrating() to check when it has finished, and get_calibration_result() to check if it succeeded
+
+    If the motor has been homed before, it first moves at full speed to just short of the minimum limit, decelerating normally.
+    It then seeks the limit at medium speed, backs off quickly by a fixed distance (the switch hysteresis plus the re-touch margin),
+    and only re-touches the limit slowly for the final latch. Until the hysteresis has been measured (or if the quick back-off 
+    doesn't release the switch), and every HOMING_REMEASURE_COUNT homings, the limit is released at medium speed instead, 
+    to measure where it releases
+*/
+void StepperModule::start_calibrate()
+{
     Serial.println("Calibrating " + name + " motor:");
     Serial.println("Finding minimum limit...");
-    set_speed(STEPPER_MEDIUM_SPEED);
-    move_relative(LONG_MIN);
-    while (is_running())
+    calibration_result = 1;         //not calibrated until the process completes successfully
+    calibration_timestamp = millis();
+    long approach = homing_margin();
+    if (homed && get_current_position() > approach)
     {
-        run(true);
+        set_speed(STEPPER_MAXIMUM_SPEED);
+        move_absolute(approach);    //the limit trips roughly hysteresis steps below zero, so stop the margin above zero
+        calibration_state = CALIBRATE_APPROACH;
     }
-    if (min_limit->read() == LOW || max_limit->read() == HIGH) 
+    else
     {
-        Serial.println("Error: " + name + " motor never reached minimum limit switch. Recalibration required");
-        return 1;               //error, min limit never reached, or pressed max limit 
+        start_seek();
     }
-    delay(500);                 //delay to stop momentum
+}
+
+
+/**
+    Slide the motor back at medium speed until it presses the minimum limit. The step interrupt stops the motor at the limit
+*/
+void StepperModule::start_seek()
+{
+    set_speed(STEPPER_MEDIUM_SPEED);
+    move_relative(LONG_MIN);
+    calibration_state = CALIBRATE_SEEK;
+}
+
+
+/**
+    Move the motor away from the minimum limit at medium speed, until the limit releases (watched by run_calibration())
+*/
+void StepperModule::start_release()
+{
+    set_speed(STEPPER_MEDIUM_SPEED);
+    released = false;
+    move_relative(HOMING_MAX_BACKOFF);
+    calibration_state = CALIBRATE_RELEASE;
+}
+
 
-    //slowly slide the motor forward until the button is released
-    Serial.println("Slowly releasing limit...");
+/**
+    Slowly move the motor back towards the minimum limit. The step interrupt stops the motor when the limit trips
+*/
+void StepperModule::start_touch()
+{
+    Serial.println("Slowly touching limit...");
     set_speed(STEPPER_MINIMUM_SPEED);
-    move_relative(LONG_MAX);
-    while (min_limit->read() == HIGH)
+    move_relative(-HOMING_MAX_BACKOFF);
+    calibration_state = CALIBRATE_TOUCH;
+}
+
+
+/**
+    Return how far past the expected trip point of the minimum limit the slow re-touch should start.
+    The margin shrinks as the switch proves consistent, down to HOMING_MIN_MARGIN
+
+    @return long margin is the distance (in steps) to touch slowly
+*/
+long StepperModule::homing_margin()
+{
+    if (spread < 0) { return HOMING_MAX_MARGIN; }
+    return constrain(HOMING_MIN_MARGIN + (long)(HOMING_SPREAD_MARGIN * spread + 0.5), HOMING_MIN_MARGIN, HOMING_MAX_MARGIN);
+}
+
+
+/**
+    Return whether or not a calibration is currently in progress
+
+    @return bool calibrating is true if the motor is calibrating, else false
+*/
+bool StepperModule::is_calibrating()
+{
+    return calibration_state != CALIBRATE_IDLE;
+}
+
+
+/**
+    Return the result of the most recent calibration
+
+    @return int result is 0 if the last calibration succeeded, and 1 if it failed (or never occurred)
+*/
+int StepperModule::get_calibration_result()
+{
+    return calibration_result;
+}
+
+
+/**
+    Save the current position, along with the hysteresis and spread of the minimum limit switch, to EEPROM.
+    Only meaningful when the motor is calibrated and stopped (e.g. parked at the end of a job)
+
+    @param int address is the EEPROM address to save at. 12 bytes are used
+*/
+void StepperModule::save_home(int address)
+{
+    EEPROM.put(address, (int32_t)get_current_position());
+    EEPROM.put(address + 4, hysteresis);
+    EEPROM.put(address + 8, spread);
+}
+
+
+/**
+    Restore the position saved by save_home(). The motor is treated as homed, so the next calibration approaches the limit 
+    at full speed and only touches it to verify the position. If the position is off, it falls back to full homing
+
+    @param int address is the EEPROM address save_home() was called with
+    @return bool restored is true if the saved values were plausible and restored, else false
+*/
+bool StepperModule::load_home(int address)
+{
+    int32_t position;
+    float saved_hysteresis;
+    float saved_spread;
+    EEPROM.get(address, position);
+    EEPROM.get(address + 4, saved_hysteresis);
+    EEPROM.get(address + 8, saved_spread);
+
+    //blank EEPROM reads as NaN, which fails these checks too
+    if (position < MIN_ABSOLUTE_STEPS || position > MAX_ABSOLUTE_STEPS ||
+        !(saved_hysteresis >= 0 && saved_hysteresis < HOMING_MAX_BACKOFF) || !(saved_spread >= -1 && saved_spread < HOMING_MAX_BACKOFF))
     {
-        run(true);
+        Serial.println("ERROR: EEPROM stored home for " + name + " motor appears to be incorrect");
+        return false;
     }
-    stop();
-    delay(500);                 //delay to prevent any next motions from occuring too soon
-    set_current_position(0);    //set this position as the zero datum for the slide
+    set_current_position(position);
+    hysteresis = saved_hysteresis;
+    spread = saved_spread;
+    homed = true;
+    verifying = true;
+    Serial.println("Restored " + name + " motor position " + String(position));
+    return true;
+}
 
-    //reset the speed back to normal
-    set_speed(STEPPER_MAXIMUM_SPEED);
-    Serial.println(name + " motor calibration complete.");
-    return 0;
+
+/**
+    Progress the calibration state machine. Called from run() while a calibration is in progress
+*/
+void StepperModule::run_calibration()
+{
+    switch (calibration_state)
+    {
+        case CALIBRATE_IDLE:            //no calibration in progress
+        break;
+
+        case CALIBRATE_APPROACH:        //wait for the fast approach to finish, then find the limit cautiously
+        {
+            if (is_running()) { break; }
+            start_seek();
+        }
+        break;
+
+        case CALIBRATE_SEEK:            //wait for the motor to stop at the minimum limit
+        {
+            if (is_running()) { break; }
+            if (min_limit->read(true) == LOW || max_limit->read(true) == HIGH) 
+            {
+                Serial.println("Error: " + name + " motor never reached minimum limit switch. Recalibration required");
+                calibration_state = CALIBRATE_IDLE; //error, min limit never reached, or pressed max limit 
+                break;
+            }
+            trip_position = get_current_position();
+            if (hysteresis < 0 || quick_backoffs >= HOMING_REMEASURE_COUNT)
+            {
+                quick_backoffs = 0;
+                start_release();                    //back off at medium speed until the limit releases, to measure the hysteresis
+                break;
+            }
+            quick_backoffs++;
+            released = false;
+            set_speed(STEPPER_MAXIMUM_SPEED);
+            move_relative((long)(hysteresis + 0.5) + homing_margin());  //back off quickly to the margin above where the limit releases
+            calibration_state = CALIBRATE_BACKOFF;
+        }
+        break;
+
+        case CALIBRATE_BACKOFF:         //wait for the quick back-off to finish, then slowly re-touch the limit
+        {
+            if (is_running()) { break; }
+            if (min_limit->read(true) == HIGH)
+            {
+                spread = HOMING_MAX_MARGIN / HOMING_SPREAD_MARGIN;  //still pressed, so widen the margin and release the limit cautiously
+                start_release();
+                break;
+            }
+            start_touch();
+        }
+        break;
+
+        case CALIBRATE_RELEASE:         //wait for the button to be released, then return to just above where it should trip again
+        {
+            if (!released && min_limit->read() == LOW)
+            {
+                release_position = get_current_position();
+                released = true;
+                stop();
+            }
+            if (is_running()) { break; }
+            if (!released)
+            {
+                Serial.println("Error: " + name + " motor minimum limit switch never released. Recalibration required");
+                calibration_state = CALIBRATE_IDLE;
+                break;
+            }
+
+            //if the hysteresis of the switch is known, return quickly to the margin above where it should trip
+            long touch_start = release_position - (long)(hysteresis + 0.5) + homing_margin();
+            if (hysteresis >= 0 && touch_start < get_current_position())
+            {
+                move_absolute(touch_start);
+                calibration_state = CALIBRATE_RETURN;
+                break;
+            }
+            start_touch();
+        }
+        break;
+
+        case CALIBRATE_RETURN:          //wait to arrive above the limit, then slowly move back until it trips
+        {
+            if (is_running()) { break; }
+            if (min_limit->read(true) == HIGH)
+            {
+                spread = HOMING_MAX_MARGIN / HOMING_SPREAD_MARGIN;  //tripped sooner than expected, so widen the margin and back off again
+                start_release();
+                break;
+            }
+            start_touch();
+        }
+        break;
+
+        case CALIBRATE_TOUCH:           //wait for the motor to stop at the minimum limit, then set the zero datum
+        {
+            if (is_running()) { break; }
+            if (min_limit->read(true) == LOW)
+            {
+                Serial.println("Error: " + name + " motor never re-touched minimum limit switch. Recalibration required");
+                calibration_state = CALIBRATE_IDLE;
+                break;
+            }
+
+            //update the rolling hysteresis, and how consistent it is. After a quick back-off the release wasn't seen,
+            //so the consistency is taken from how far the slow trip point was from where the seek tripped instead
+            float measured = release_position - get_current_position();
+            if (!released)
+            {
+                float deviation = abs(get_current_position() - trip_position);
+                spread = spread < 0 ? deviation : spread + HOMING_FILTER_WEIGHT * (deviation - spread);
+            }
+            else if (hysteresis >= 0)
+            {
+                float deviation = abs(measured - hysteresis);
+                spread = spread < 0 ? deviation : spread + HOMING_FILTER_WEIGHT * (deviation - spread);
+                hysteresis += HOMING_FILTER_WEIGHT * (measured - hysteresis);
+            }
+            else
+            {
+                hysteresis = measured;
+            }
+
+            //zero stays where the switch releases, i.e. hysteresis steps above where it trips
+            long zero = get_current_position() + (long)(hysteresis + 0.5);
+            if (verifying && abs(zero) > HOMING_VERIFY_TOLERANCE)
+            {
+                //the restored position can't be trusted, so neither can anything else that was saved with it
+                Serial.println("Error: " + name + " motor restored position was off by " + String(zero) + " steps. Falling back to full homing");
+                verifying = false;
+                homed = false;
+                hysteresis = -1;
+                spread = -1;
+                start_seek();
+                break;
+            }
+            if (verifying) { Serial.println(name + " motor restored position verified"); }
+            verifying = false;
+            set_current_position(get_current_position() - zero);
+
+            //reset the speed back to normal
+            set_speed(STEPPER_MAXIMUM_SPEED);
+            Serial.println(name + " motor calibration complete in " + String(millis() - calibration_timestamp) + "ms.");
+            if (homed) { Serial.println("Zero moved " + String(zero) + " steps since the last calibration"); }
+            Serial.println("Limit hysteresis: " + String(hysteresis) + " steps, spread: " + String(spread) + " steps");
+            homed = true;
+            calibration_result = 0;
+            calibration_state = CALIBRATE_IDLE;
+        }
+        break;
+    }
 }
 
 
 /**
-    Set the maximum acceleration of the stepper motor
+    Set the maximum acceleration and deceleration of the stepper motor
 
     @param float acceleration is the acceleration of the stepper motor in steps/second^2
+    @param (optional) float deceleration is the deceleration of the stepper motor in steps/second^2. Default is 0, which uses the acceleration
+*/
+void StepperModule::set_acceleration(float acceleration, float deceleration)
+{
+    this->acceleration = acceleration;
+    this->deceleration = deceleration > 0 ? deceleration : acceleration;
+    update_ramp();
+}
+
+
+/**
+    Set the shape of the acceleration ramps used by every move
+
+    @param motion_profiles profile is TRAPEZOIDAL_PROFILE or S_CURVE_PROFILE
+    @param (optional) float jerk is the maximum rate of change of acceleration (steps/second^3). Only used by S_CURVE_PROFILE
 */
-void StepperModule::set_acceleration(float acceleration)
+void StepperModule::set_profile(motion_profiles profile, float jerk)
 {
-    motor->setAcceleration(acceleration);
+    this->profile = profile;
+    this->jerk = jerk;
+    update_ramp();
+}
+
+
+/**
+    Recompute the acceleration ramp of the step generator from the maximum speed, acceleration, deceleration and profile
+*/
+void StepperModule::update_ramp()
+{
+    motor->set_ramp(STEPPER_MAXIMUM_SPEED, acceleration, deceleration, profile == S_CURVE_PROFILE ? jerk : 0);
 }
 
 
@@ -122,7 +424,7 @@ void StepperModule::set_acceleration(float acceleration)
 */
 void StepperModule::set_current_position(long position)
 {
-    motor->setCurrentPosition(position);
+    motor->set_position(position);
 }
 
 /**
@@ -132,7 +434,32 @@ void StepperModule::set_current_position(long position)
 */
 long StepperModule::get_current_position()
 {
-    return motor->currentPosition();
+    return motor->get_position();
+}
+
+
+/**
+    Return the position counter updated by the step interrupt. Only other interrupts may read it directly
+
+    @return const volatile long* position is the step position of the motor
+*/
+const volatile long* StepperModule::get_position_register()
+{
+    return motor->get_position_register();
+}
+
+
+/**
+    Return the worst latency of the step interrupt (from the step being due until the interrupt finished), and the number 
+    of steps taken late because of it, since the last call. Used to check MIN_STEP_INTERVAL against the running robot
+
+    @return String timing is the latency in microseconds, and the number of late steps
+*/
+String StepperModule::step_timing()
+{
+    uint16_t latency = motor->take_max_latency();
+    unsigned int late = motor->take_late_steps();
+    return String(latency / (STEP_TICKS_PER_SECOND / 1000000)) + "us worst step latency, " + String(late) + " late steps";
 }
 
 
@@ -143,7 +470,7 @@ long StepperModule::get_current_position()
 */
 void StepperModule::set_speed(float speed)
 {
-    motor->setMaxSpeed(speed);
+    motor->set_speed(speed);
 }
 
 
@@ -161,6 +488,7 @@ void StepperModule::set_speeds(float min, float med, float max)
     STEPPER_MEDIUM_SPEED = med;
     STEPPER_MAXIMUM_SPEED = max;
     set_speed(STEPPER_MAXIMUM_SPEED);
+    update_ramp();
 }
 
 
@@ -173,10 +501,107 @@ void StepperModule::set_speeds(float min, float med, float max)
 */
 void StepperModule::move_absolute(long absolute, bool block)
 {
-    motor->moveTo(absolute);            //command the stepper to an absolute target
+    clear_queue();                      //a direct move replaces any queued segments
+    motor->move_to(constrain(absolute, MIN_ABSOLUTE_STEPS, MAX_ABSOLUTE_STEPS));  //command the stepper to an absolute target
     if (block) { wait_till_done(); }    //complete entire motion before returning
 }
 
+/**
+    Add a move to the specified absolute position to the next coordinated move. 
+    The motor doesn't move until start() is called on the coordinator, and then starts and arrives together with every other axis in the move
+
+    @param MotionCoordinator* coordinator is the coordinator to move the motor with
+    @param long absolute is the absolute position to move to in steps relative to the origin
+*/
+void StepperModule::add_to(MotionCoordinator* coordinator, long absolute)
+{
+    coordinator->add(motor, constrain(absolute, MIN_ABSOLUTE_STEPS, MAX_ABSOLUTE_STEPS));
+}
+
+/**
+    Add a segment to the end of the move queue. Starts moving straight away if the motor is idle.
+    If the segment continues in the same direction as the one before it, the motor carries its speed through into it
+    instead of stopping in between. A move already in progress (from move_absolute()) becomes the first segment
+
+    @param long absolute is the absolute position the segment ends at, in steps relative to the origin
+    @return bool success is true if the segment was queued (or is already where the queue ends), else false if the queue is full
+*/
+bool StepperModule::queue_absolute(long absolute)
+{
+    absolute = constrain(absolute, MIN_ABSOLUTE_STEPS, MAX_ABSOLUTE_STEPS);
+    if (queue_length == 0 && motor->is_running())   //keep the move in progress as the first segment
+    {
+        queue_head = 0;
+        queue_targets[0] = motor->get_target();
+        queue_directions[0] = motor->get_distance() > 0 ? 1 : -1;
+        queue_length = 1;
+    }
+
+    long end = queue_length > 0 ? queue_targets[(queue_head + queue_length - 1) % MOVE_QUEUE_LENGTH] : get_current_position();
+    if (absolute == end) { return true; }           //already ends here, so nothing to add
+    if (queue_length >= MOVE_QUEUE_LENGTH)
+    {
+        Serial.println("ERROR: " + name + " motor move queue is full");
+        return false;
+    }
+
+    uint8_t index = (queue_head + queue_length) % MOVE_QUEUE_LENGTH;
+    queue_targets[index] = absolute;
+    queue_directions[index] = absolute > end ? 1 : -1;
+    queue_length++;
+    run_queue();
+    return true;
+}
+
+
+/**
+    Return the number of queued segments that haven't been completed yet (including the one in progress)
+
+    @return int length is the number of segments left in the move queue
+*/
+int StepperModule::get_queue_length()
+{
+    return queue_length;
+}
+
+
+/**
+    Drop any queued segments the motor has passed the end of, and then target the end of the run of segments in the same direction 
+    as the one in progress. The motor only decelerates at the end of that run, so segments within it are blended together
+*/
+void StepperModule::run_queue()
+{
+    long position = get_current_position();
+    while (queue_length > 0 && (position - queue_targets[queue_head]) * queue_directions[queue_head] >= 0)
+    {
+        queue_head = (queue_head + 1) % MOVE_QUEUE_LENGTH;
+        queue_length--;
+    }
+    if (queue_length == 0) { return; }
+
+    long end = queue_targets[queue_head];
+    for (uint8_t i = 1; i < queue_length; i++)
+    {
+        uint8_t index = (queue_head + i) % MOVE_QUEUE_LENGTH;
+        if (queue_directions[index] != queue_directions[queue_head]) { break; }
+        end = queue_targets[index];
+    }
+    if (motor->get_target() != end || !motor->is_running())
+    {
+        motor->move_to(end);
+    }
+}
+
+
+/**
+    Remove every segment from the move queue. The motor keeps moving towards its current target
+*/
+void StepperModule::clear_queue()
+{
+    queue_length = 0;
+}
+
+
 /**
     Command the motor to move to the specified relative position
 
@@ -185,8 +610,9 @@ void StepperModule::move_absolute(long absolute, bool block)
 */
 void StepperModule::move_relative(long relative, bool block)
 {
-    motor->move(relative);              //command the slide stepper to a relative target
-    if (block) { wait_till_done(); }    //complete entire motion before returning
+    long current = get_current_position();
+    relative = constrain(relative, MIN_ABSOLUTE_STEPS - current, MAX_ABSOLUTE_STEPS - current);  //prevent the target from overflowing
+    move_absolute(current + relative, block);
 }
 
 
@@ -198,7 +624,7 @@ void StepperModule::move_relative(long relative, bool block)
 */
 long StepperModule::get_distance()
 {
-    return motor->distanceToGo();
+    return motor->get_distance();
 }
 
 
@@ -218,37 +644,78 @@ void StepperModule::wait_till_done()
 */
 void StepperModule::stop()
 {
-    move_absolute(get_current_position());          //set the current target to current location
-    set_current_position(get_current_position());   //(via function side effect) set the motor velocity to zero
+    clear_queue();
+    motor->stop();
 }
 
 
 /**
-    Call once per loop. Perform any current movement for the motor, and stop the motor if a limit is pressed
+    Call once per loop. Progress any calibration in progress, and report if a limit switch stopped the motor.
+    Steps are generated (and limit switches checked) in the background by the StepGenerator, so the motor moves even if this isn't called
+*/
+void StepperModule::run()
+{
+    run(true);
+    if (calibration_state != CALIBRATE_IDLE)
+    {
+        run_calibration();
+    }
+}
+
 
-    @param (optional) bool check is whether or not the limits should be monitored. 
-    true (default) means monitor limits, false means don't monitor 
+/**
+    Handle any limit switch stop, and progress any queued segments. 
+    The limit switch in the direction of travel is always monitored by the step interrupt, which stops the motor itself
+
+    @param bool check is whether or not limit stops should be reported. 
+    true means report limit stops, false means stop silently
     @param (optional) bool conservative indicates that limit checks will be strict.
     false (default) means only switch in direction of travel can stop motor while true means either button will stop motor
 */
 void StepperModule::run(bool check, bool conservative)
 {
-    if (check) 
+    check_limits(check, conservative);  //if a limit switch stopped the motor, abandon the rest of the queued segments
+    if (queue_length > 0)
     {
-        check_limits(conservative); //if the limit switches are pressed, stop the motor 
-    }  
-    motor->run();                   //command motion towards the current target
+        run_queue();                //move on to the next queued segments
+    }
 }
 
 
 /**
-    Return whether or not the motor is currently moving
+    Return whether or not the motor is currently moving, or has queued segments left to move
 
     @return bool is_running is true if the motor is moving, else false
 */
 bool StepperModule::is_running()
 {
-    return motor->isRunning();
+    return motor->is_running() || queue_length > 0;
+}
+
+
+/**
+    Return whether or not the motor is busy, i.e. moving or calibrating
+
+    @return bool is_busy is true if the motor is moving or calibrating, else false
+*/
+bool StepperModule::is_busy()
+{
+    return is_running() || is_calibrating();
+}
+
+
+/**
+    Stop the motor, and abandon any calibration in progress (the motor will need to be recalibrated)
+*/
+void StepperModule::cancel()
+{
+    if (is_calibrating())
+    {
+        Serial.println(name + " motor calibration cancelled");
+        set_speed(STEPPER_MAXIMUM_SPEED);
+        calibration_state = CALIBRATE_IDLE;
+    }
+    stop();
 }
 
 
@@ -263,30 +730,26 @@ void StepperModule::reset_limit_buffers()
 
 
 /**
-    Check if the motor has pressed either the min or max limit switch. If so, stop the motor
+    Check if the step interrupt stopped the motor at the min or max limit switch. If so, clear the move queue so it doesn't continue.
+    The switches are only read here in conservative mode, as the interrupt already watches the switch in the direction of travel
 
+    @parameter bool report indicates whether a limit stop should be printed
     @parameter bool conservative indicates that the checks should be more strict
     true means that any limit pressed will stop the motor, while false only checks the direction of travel
 */
-void StepperModule::check_limits(bool conservative)
+void StepperModule::check_limits(bool report, bool conservative)
 {
-    long distance = get_distance(); //current distance remaining to target location (sign indicates direction of travel)
-    
-    //update the internal switch buffers, and store their current state
-    uint8_t min_state = min_limit->read();
-    uint8_t max_state = max_limit->read();
-    
-    if (distance > 0 && max_state == HIGH)                              //max limit button was pressed and direction of travel is forward
+    int8_t limit = motor->take_limit_hit();                             //which limit (if any) the interrupt stopped the motor at
+    if (limit != 0)
     {
-        stop();                                                         //stop the motor motion immediately
-        Serial.println("Stopping " + name + " motor at MAX_LIMIT");     //print a status message
+        clear_queue();                                                  //don't continue on to any queued segments
+        if (report) { Serial.println("Stopping " + name + " motor at " + (limit > 0 ? "MAX_LIMIT" : "MIN_LIMIT")); }
     }
-    else if (distance < 0 && min_state == HIGH)                         //min limit button was pressed and direction of travel is backward
-    {
-        stop();                                                         //stop the motor immediately
-        Serial.println("Stopping " + name + " motor at MIN_LIMIT");     //print a status message
-    }
-    else if (conservative && (min_state == HIGH || max_state == HIGH))  //be very conservative--either button stops the motor regardless of direction of travel
+
+    if (!conservative || !motor->is_running()) { return; }
+    uint8_t min_state = min_limit->read();
+    uint8_t max_state = max_limit->read();
+    if (min_state == HIGH || max_state == HIGH)                         //be very conservative--either button stops the motor regardless of direction of travel
     {
         stop();                                                         //stop the motor immediately
         Serial.print("Stopping " + name + " motor. ");                  //print status message
@@ -34,15 +34,36 @@
 #define STEPPER_MODULE_H
 
 #include <Arduino.h>
-#include <AccelStepper.h>
 #include "ButtonModule.h"
-
-#define MAX_ABSOLUTE_STEPS 1000000000   //apparently there is a bug in AccelStepper, and you cannot call moveTo() with a number that is too large (depends on the step current location)
-#define MIN_ABSOLUTE_STEPS -1000000000  //same bug in AccelStepper--you cannot call moveTo() with a number that is too small
+#include "StepGenerator.h"
+#include "MotionCoordinator.h"
+
+#define MAX_ABSOLUTE_STEPS 1000000000   //largest target position. Relative moves are clamped to this so they can't overflow the position
+#define MIN_ABSOLUTE_STEPS -1000000000  //smallest target position. Relative moves are clamped to this so they can't overflow the position
+#define HOMING_MIN_MARGIN 5             //smallest distance (steps) above the expected trip point of the minimum limit to start the slow re-touch
+#define HOMING_MAX_MARGIN 40            //largest slow re-touch margin (steps), used until the repeatability of the switch is known
+#define HOMING_SPREAD_MARGIN 3          //re-touch margin per step of measured hysteresis spread (i.e. margin covers 3x the spread)
+#define HOMING_MAX_BACKOFF 2000         //furthest (steps) to back off looking for the minimum limit to release before failing
+#define HOMING_FILTER_WEIGHT 0.25       //weight of the latest homing in the rolling hysteresis and spread measurements
+#define HOMING_REMEASURE_COUNT 10       //quick back-offs between re-measuring the hysteresis by releasing the limit at medium speed
+#define HOMING_VERIFY_TOLERANCE 50      //furthest (steps) the zero may move when verifying a restored position before falling back to full homing
+#define MOVE_QUEUE_LENGTH 4             //maximum number of segments that can be queued for a motor
+
+enum motion_profiles
+{
+    TRAPEZOIDAL_PROFILE,                //constant acceleration up to the cruise speed, and constant deceleration to the target
+    S_CURVE_PROFILE                     //jerk limited acceleration, i.e. acceleration ramps up and down smoothly instead of switching instantly
+};
 
 /**
-    The StepperModule class wraps the AccelStepper class to manage a stepper motor on the robot.
-    This class controls important aspects of the motor while monitoring limits switches.
+    The StepperModule class manages a stepper motor on the robot.
+    Step pulses are generated in the background by a StepGenerator on a dedicated hardware timer,
+    while this class controls important aspects of the motor and monitors the limit switches.
+    Moves follow a trapezoidal or S-curve motion profile, with separate acceleration and deceleration limits for each axis.
+
+    Several segments can be queued with queue_absolute(). Consecutive segments in the same direction are blended into one
+    continuous motion, i.e. the motor only slows down where the direction changes, or at the end of the queue.
+    get_queue_length() counts down as each segment end is passed, so actions can be triggered along the way without stopping.
 
     Example Usage:
 
@@ -54,27 +75,43 @@ class StepperModule
 {
 public:
     //constructor for the stepper motor module, given pins for the motor and limit switches
-    StepperModule(uint8_t pin_pulse, uint8_t pin_direction, uint8_t pin_min_limit, uint8_t pin_max_limit, String name, bool reverse=false);
+    StepperModule(uint8_t pin_pulse, uint8_t pin_direction, uint8_t pin_min_limit, uint8_t pin_max_limit, step_timers timer, String name, bool reverse=false);
     
-    int calibrate();                                        //drive the motor to the minimum limit and set the position to 0
+    int calibrate();                                        //drive the motor to the minimum limit and set the position to 0 (blocking)
+    void start_calibrate();                                 //begin calibrating without blocking. Progressed by run()
+    bool is_calibrating();                                  //return whether or not a calibration is in progress
+    int get_calibration_result();                           //return the result of the most recent calibration. 0 for success, 1 for failure
+    void save_home(int address);                            //save the current position and limit switch measurements to EEPROM (12 bytes)
+    bool load_home(int address);                            //restore the position saved by save_home(). The next calibration verifies it with a quick touch
     void set_current_position(long position);               //update the current position of the stepper motor
     long get_current_position();                            //get the current position of the stepper motor
+    const volatile long* get_position_register();           //get the position counter of the step interrupt, for stamping samples from other interrupts
+    String step_timing();                                   //return (and reset) the worst step interrupt latency, and the number of late steps
     void set_speed(float speed);                            //set the current speed of the stepper motor (in steps/second)
-    void set_acceleration(float acceleration);              //set the maximum acceleration of the motor
+    void set_acceleration(float acceleration,               //set the maximum acceleration (and deceleration) of the motor
+        float deceleration=0);
+    void set_profile(motion_profiles profile, float jerk=0);//set the shape of the acceleration ramps. jerk is required for S_CURVE_PROFILE
     void set_speeds(float min, float med, float max);       //set the minimum, medium and maximum speeds for the stepper motor                          
     void move_relative(long relative, bool block=false);    //move the slide motor relatively by the specified number (in steps)
     void move_absolute(long absolute, bool block=false);    //move the slide motor to the absolute position (in steps)
+    void add_to(MotionCoordinator* coordinator,             //move to the absolute position (in steps) as part of the next coordinated move
+        long absolute);
+    bool queue_absolute(long absolute);                     //add a segment to the absolute position (in steps) to the move queue. Return false if the queue is full
+    int get_queue_length();                                 //return the number of queued segments that haven't been completed
     long get_distance();                                    //return the distance to the currently targeted location
     void stop();                                            //immediately stop the current motion of the motor
-    void run(bool check=true, bool conservative=false);     //NEEDS TO BE CALLED ONCE PER LOOP(). Run the motor to any specified positions and (if check=true) monitor limit switches
+    void run();                                             //NEEDS TO BE CALLED ONCE PER LOOP(). Progress calibration, and report limit switch stops (steps and limits are handled in the background)
+    void run(bool check, bool conservative=false);          //handle limit switch stops (reporting them if check=true), and progress the move queue
     bool is_running();                                      //return whether or not the motor is currently moving to a target.
+    bool is_busy();                                         //return whether or not the motor is moving or calibrating
+    void cancel();                                          //stop the motor, and abandon any calibration in progress
     void reset_limit_buffers();                             //reset the limit switch buffers to unpressed
 
     String str();                                           //print out the current state of the stepper motor
     String repr();                                          //print out the underlying representation of the stepper motor
 
 private:
-    AccelStepper* motor;                                    //AccelStepper object for controlling the stepper motor
+    StepGenerator* motor;                                   //interrupt driven step generator for the stepper motor
     ButtonModule* min_limit;                                //ButtonModule object for reading the minimum limit switch
     ButtonModule* max_limit;                                //ButtonModule object for reading the maximum limit switch
     String name;                                            //name of this motor
@@ -82,9 +119,66 @@ private:
     float STEPPER_MINIMUM_SPEED = 50;                       //minimum speed to drive the stepper motor at. This is used as the precise dviving speed (while releasing limits during calibration)
     float STEPPER_MEDIUM_SPEED = 1000;                      //medium speed to drive the stepper motor at. This is used as the cautious driving speed (while searching for limits during calibration)
     float STEPPER_MAXIMUM_SPEED = 4000;                     //maximum speed to drive the stepper motor at. This is used as the normal driving speed
-
+    float acceleration = 100000;                            //maximum acceleration of the motor (steps/second^2)
+    float deceleration = 100000;                            //maximum deceleration of the motor (steps/second^2)
+    motion_profiles profile = TRAPEZOIDAL_PROFILE;          //shape of the acceleration ramps
+    float jerk = 0;                                         //maximum jerk (steps/second^3) for S_CURVE_PROFILE
+
+    long queue_targets[MOVE_QUEUE_LENGTH];                  //end position of each queued segment
+    int8_t queue_directions[MOVE_QUEUE_LENGTH];             //direction of travel of each queued segment (1 or -1)
+    uint8_t queue_head = 0;                                 //index of the segment in progress
+    uint8_t queue_length = 0;                               //number of queued segments that haven't been completed
+
+    enum calibration_states
+    {
+        CALIBRATE_IDLE,                                     //no calibration in progress
+        CALIBRATE_APPROACH,                                 //moving at full speed (with the normal deceleration ramp) to just short of the known minimum limit
+        CALIBRATE_SEEK,                                     //moving towards the minimum limit at medium speed
+        CALIBRATE_BACKOFF,                                  //moving forward at full speed a fixed distance (hysteresis + margin) above where the minimum limit tripped
+        CALIBRATE_RELEASE,                                  //moving forward at medium speed until the minimum limit releases, measuring its hysteresis
+        CALIBRATE_RETURN,                                   //moving back at medium speed to the margin above where the minimum limit should trip
+        CALIBRATE_TOUCH                                     //slowly moving back until the minimum limit trips again
+
+        //Transitions are as follows:
+        //CALIBRATE_IDLE            ->  CALIBRATE_APPROACH        :  when start_calibrate() is called, if the motor has been homed before
+        //CALIBRATE_IDLE            ->  CALIBRATE_SEEK            :  when start_calibrate() is called, if the motor has never been homed
+        //CALIBRATE_APPROACH        ->  CALIBRATE_SEEK            :  motor stopped short of the minimum limit (or stopped on it)
+        //CALIBRATE_SEEK            ->  CALIBRATE_BACKOFF         :  motor stopped at the minimum limit, and its hysteresis is known
+        //CALIBRATE_SEEK            ->  CALIBRATE_RELEASE         :  motor stopped at the minimum limit, and its hysteresis hasn't been measured (for HOMING_REMEASURE_COUNT homings)
+        //CALIBRATE_SEEK            ->  CALIBRATE_IDLE            :  motor stopped without reaching the minimum limit (failure)
+        //CALIBRATE_BACKOFF         ->  CALIBRATE_TOUCH           :  motor stopped with the minimum limit released
+        //CALIBRATE_BACKOFF         ->  CALIBRATE_RELEASE         :  minimum limit still pressed. The margin is widened and the limit released at medium speed
+        //CALIBRATE_RELEASE         ->  CALIBRATE_RETURN          :  minimum limit released, and its hysteresis is known
+        //CALIBRATE_RELEASE         ->  CALIBRATE_TOUCH           :  minimum limit released, and its hysteresis hasn't been measured yet
+        //CALIBRATE_RELEASE         ->  CALIBRATE_IDLE            :  minimum limit never released (failure)
+        //CALIBRATE_RETURN          ->  CALIBRATE_TOUCH           :  motor stopped above the minimum limit
+        //CALIBRATE_RETURN          ->  CALIBRATE_RELEASE         :  minimum limit tripped early. The margin is widened and the limit released again
+        //CALIBRATE_TOUCH           ->  CALIBRATE_IDLE            :  minimum limit tripped, position is set to zero (success), or motor stopped without tripping it (failure)
+        //CALIBRATE_TOUCH           ->  CALIBRATE_SEEK            :  a restored position was off by more than HOMING_VERIFY_TOLERANCE. Homing starts over from scratch
+    };
+
+    calibration_states calibration_state = CALIBRATE_IDLE;  //current step of the calibration process
+    unsigned long calibration_timestamp = 0;                //time (milliseconds) that the current calibration started
+    int calibration_result = 1;                             //result of the most recent calibration. 0 for success, 1 for failure
+    bool homed = false;                                     //whether the motor has been calibrated before, i.e. the position of the limit is roughly known
+    long trip_position = 0;                                 //position the motor stopped at when seeking the minimum limit
+    long release_position = 0;                              //position the minimum limit released at while backing off
+    bool released = false;                                  //whether the minimum limit release was measured during the current calibration
+    uint8_t quick_backoffs = 0;                             //number of quick back-offs since the hysteresis was last measured
+    float hysteresis = -1;                                  //rolling distance (steps) between where the minimum limit trips and releases. -1 if unmeasured
+    float spread = -1;                                      //rolling deviation (steps) of the measured hysteresis (or trip point) between homings. -1 if unmeasured
+    bool verifying = false;                                 //whether the position was restored from EEPROM, and needs to be checked by the next calibration
+
+    void run_calibration();                                 //progress the calibration state machine
+    void start_seek();                                      //begin moving towards the minimum limit at medium speed
+    void start_release();                                   //begin moving away from the minimum limit at medium speed until it releases
+    void start_touch();                                     //begin slowly moving back until the minimum limit trips
+    long homing_margin();                                   //return how far (steps) to back off past the release point before the slow re-touch
+    void update_ramp();                                     //recompute the acceleration ramp of the step generator
+    void run_queue();                                       //drop completed segments, and target the end of the segments in the current direction
+    void clear_queue();                                     //remove every queued segment
     void wait_till_done();                                  //block until the motor has reached it's current target or pressed a limit
-    void check_limits(bool conservative);                   //check if the motor is within bounds. If conservative, either switch will stop the motor, else, only in the direction of travel
+    void check_limits(bool report, bool conservative);      //handle limit stops from the step interrupt. If conservative, either switch will also stop the motor
 };
 
 #endif
\ No newline at end of file
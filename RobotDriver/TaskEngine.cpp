@@ -0,0 +1,123 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    TaskEngine.cpp
+    Purpose: Cooperative task engine that runs module actions concurrently
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#include "TaskEngine.h"
+
+
+/**
+    Constructor for the task engine. Starts with no tasks registered
+*/
+TaskEngine::TaskEngine()
+{
+    num_tasks = 0;
+}
+
+
+/**
+    Register a task to be updated every time the engine is run
+
+    @param Task* task is the task to add to the engine
+*/
+void TaskEngine::add(Task* task)
+{
+    if (num_tasks >= MAX_TASKS)
+    {
+        Serial.println("ERROR: TaskEngine can only run " + String(MAX_TASKS) + " tasks");
+        return;
+    }
+    tasks[num_tasks++] = task;
+}
+
+
+/**
+    Update every registered task once. THIS NEEDS TO BE CALLED ONCE PER LOOP().
+*/
+void TaskEngine::run()
+{
+    for (int i = 0; i < num_tasks; i++)
+    {
+        tasks[i]->update();
+    }
+}
+
+
+/**
+    Block until none of the registered tasks are busy. Every task continues to be updated while waiting
+*/
+void TaskEngine::wait()
+{
+    while (is_busy())
+    {
+        run();
+    }
+}
+
+
+/**
+    Block until the specified task is no longer busy. Every task continues to be updated while waiting
+
+    @param Task* task is the task to wait for
+*/
+void TaskEngine::wait(Task* task)
+{
+    while (task->is_busy())
+    {
+        run();
+    }
+}
+
+
+/**
+    Check if any of the registered tasks are busy
+
+    @return bool busy is true if any task has an action in progress, else false
+*/
+bool TaskEngine::is_busy()
+{
+    for (int i = 0; i < num_tasks; i++)
+    {
+        if (tasks[i]->is_busy()) { return true; }
+    }
+    return false;
+}
+
+
+/**
+    Abandon the action in progress for every registered task
+*/
+void TaskEngine::cancel()
+{
+    for (int i = 0; i < num_tasks; i++)
+    {
+        tasks[i]->cancel();
+    }
+}
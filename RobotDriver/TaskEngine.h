@@ -0,0 +1,98 @@
+/**
+    MIT License
+
+    Copyright (c) 2019 David-Andrew Samson
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    PRS Fret Press Robot
+    TaskEngine.h
+    Purpose: Header for the cooperative task engine that runs module actions concurrently
+
+    @author David Samson
+    @version 1.0
+    @date 2026-10-17
+*/
+
+#ifndef TASK_ENGINE_H
+#define TASK_ENGINE_H
+
+#include <Arduino.h>
+
+#define MAX_TASKS 8                     //maximum number of tasks that can be registered with the engine
+
+
+/**
+    The Task class is the interface for anything on the robot with actions that take time to complete.
+    Instead of blocking until an action is finished, a task starts the action, and then progresses it 
+    a little bit every time update() is called, i.e. each action is a resumable state machine.
+*/
+class Task
+{
+public:
+    virtual void update() = 0;          //progress any action in progress. Called once per loop by the TaskEngine
+    virtual bool is_busy() = 0;         //return whether or not an action is in progress
+    virtual void cancel() = 0;          //abandon any action in progress
+};
+
+
+/**
+    The TaskEngine class runs every task on the robot cooperatively from the main loop.
+    Each call to run() updates every registered task once, so that all tasks progress concurrently.
+    Since no task blocks, serial commands can still be read while tasks are in progress.
+
+    Example Usage:
+
+    ```
+    TaskEngine* engine = new TaskEngine();
+    engine->add(slide_module);
+    engine->add(glue_module);
+
+    setup()
+    {
+        slide_module->start_calibrate();    //start both calibrations at the same time
+        glue_module->start_calibrate();
+        engine->wait();                     //block (while running every task) until both are complete
+    }
+
+    loop()
+    {
+        engine->run();                      //needs to be called once per loop to progress all tasks
+    }
+    ```
+*/
+class TaskEngine
+{
+public:
+    //constructor for the task engine
+    TaskEngine();
+
+    void add(Task* task);               //register a task to be updated every loop
+    void run();                         //NEEDS TO BE CALLED ONCE PER LOOP(). Update every registered task
+    void wait();                        //block until no tasks are busy, while updating every task
+    void wait(Task* task);              //block until the specified task is not busy, while updating every task
+    bool is_busy();                     //return whether or not any task is busy
+    void cancel();                      //abandon the actions in progress for every task
+
+private:
+    Task* tasks[MAX_TASKS];             //every task registered with the engine
+    int num_tasks = 0;                  //number of tasks registered
+};
+
+#endif
@@ -85,7 +85,7 @@ void Utilities::serial_control()
         }
         reset_buffer();         //reset the buffer variables for next command
     }
-    run_motors();   //run any of the motors if currently in motion
+    run_tasks();    //progress any of the motors/actions currently in progress
 }
 
 
@@ -143,10 +143,8 @@ long Utilities::get_buffer_num(int i)
 */
 void Utilities::kill_command()
 {
-    //stop all motors from moving
-    slide_module->motor->stop();
-    glue_module->motor->stop();
-    press_module->motor->stop();
+    //stop all motors from moving, and abandon any actions in progress
+    robot->engine->cancel();
 
     //set all pneumatics to default state
     glue_module->glue->write(LOW);      //glue stream off
@@ -168,7 +166,7 @@ void Utilities::slide_command()
     {
         case 'c':   //slide "calibrate" - move the slide motor to the min limit and set position to zero
         {
-            slide_module->calibrate();
+            slide_module->start_calibrate();
             break;
         }
         case 'm':   //slide "move" - move the slide motor relative to current position
@@ -195,7 +193,6 @@ void Utilities::slide_command()
             long offset;                        //offset for slot alignment
             char target = command_buffer[2];    //device to target (laser, glue, or press)
             int num_slots = laser_module->get_num_slots();          //get the current number of slots
-            long* slot_buffer = laser_module->get_slot_buffer();    //get the list of slot indices
 
             switch (target) //save the step offset for the specific target
             {
@@ -216,14 +213,14 @@ void Utilities::slide_command()
                 }
                 else
                 {
-                    slide_module->motor->move_absolute(slot_buffer[index] + offset);
+                    slide_module->motor->move_absolute(laser_module->get_slot_position(index) + offset);
                 }
             }
             else                                                    //negative index means target all slots
             {
                 for (int i = 0; i < num_slots; i++)
                 {
-                    slide_module->motor->move_absolute(slot_buffer[i] + offset, true);
+                    slide_module->motor->move_absolute(laser_module->get_slot_position(i) + offset, true);
                     delay(1000);
                 }
             }
@@ -249,7 +246,7 @@ void Utilities::press_command()
     {
         case 'c':   //press "calibrate" - move to the minimum stepper motor limit and set as the origin
         {
-            press_module->calibrate();
+            press_module->start_calibrate();
             break;
         }
         case 'm':   //press "move" - move the press motor relative to current position
@@ -313,7 +310,7 @@ void Utilities::glue_command()
     {
         case 'c':   //glue "calibrate" - move the glue motor to the min limit and set position to zero
         {
-            glue_module->calibrate();
+            glue_module->start_calibrate();
             break;
         }
         case 'm':   //glue "move" - move the glue motor relative to current position
@@ -415,7 +412,7 @@ void Utilities::laser_command()
     {
         case 'c':   //laser "calibrate" - calibrate the laser sensor
         {
-            laser_module->calibrate();
+            laser_module->start_calibrate();
             break;
         }
         case 't':   //laser "toggle" - toggle the laser emitter on/off 
@@ -444,6 +441,11 @@ void Utilities::laser_command()
             robot->update_laser_offset(delta);
             break;
         }
+        case 'x':   //laser "capture" - stream the raw samples of the next slot detection
+        {
+            laser_module->capture(command_buffer[2] == 0 || get_buffer_num() != 0);
+            break;
+        }
         default: Serial.println("Unrecognized command for laser: \"" + String(action) + "\"");
     }
 }
@@ -462,13 +464,6 @@ void Utilities::robot_command()
             robot->calibrate();
             break;
         }
-        // case 'b':   //robot "batch" - set the batch size for number of frets pressed/glued at a time
-        // {
-        //     Serial.println("This function currently is not implemented. To update batch size, either manually change it in Robot.h, or complete this function");
-        //     // group = (int) get_buffer_num(2);                    //get the new batch size from buffer
-        //     // robot->update_group_size(group);                    //tell the robot to use the new size
-        //     break;
-        // }
         case 'e':   //robot "error" - check for errors in the robot, e.g. out of fret wire, out of glue, etc.
         {
             //consider refactoring this to not calibrate, and just check fret wire/glue
@@ -486,67 +481,54 @@ void Utilities::robot_command()
             robot->detect_slots();
             break;
         }
-        case 'g':   //robot "glue" - glue the specified slot on the board
+        case 'g':   //robot "glue" - glue the specified slot on the board (-1 for all slots)
         {
-            int num_slots = laser_module->get_num_slots();          //get the current number of slots
-            long* slot_buffer = laser_module->get_slot_buffer();    //get the list of slot indices
-            int index = (int) get_buffer_num(2);                    //get the target index from the buffer
-
-            if (index >= 0)
+            robot->start_glue_slots((int) get_buffer_num(2));
+            break;
+        }
+        case 'p':   //robot "press" - press the specified slot on the board (-1 for all slots)
+        {
+            robot->start_press_slots((int) get_buffer_num(2));
+            break;
+        }
+        case 'b':   //robot "both"/"batch" - glue and press frets along the entire board, or set the batch size if a number is given
+        {
+            if (command_buffer[2] == 0)                             //no number given, so glue and press the whole board
             {
-                if (index < num_slots)                          //confirm the index refers to a real slot
-                {
-                    slide_module->motor->move_absolute(slot_buffer[index] + robot->GLUE_ALIGNMENT_OFFSET, true);
-                }
-                else
-                {
-                    Serial.println("Error: Specified slot index \"" + String(index) + "\" is larger than max slot index " + String(num_slots - 1));
-                }
-                glue_module->glue_slot();
+                robot->press_frets();
             }
-            else    //glue pass every slot in sequence
+            else                                                    //set the number of frets pressed/glued at a time (0 for auto-tune)
             {
-                glue_module->set_direction(1);                  //set the glue to start in the positive direction
-                glue_module->motor->move_absolute(12000, true); //move the glue motor out of the way of the slide
-                for (int i = 0; i < num_slots; i++)
-                {
-                    slide_module->motor->move_absolute(slot_buffer[i] + robot->GLUE_ALIGNMENT_OFFSET, true);
-                    glue_module->glue_slot();
-                }
+                int size = (int) get_buffer_num(2);                 //get the new batch size from buffer
+                robot->set_batch_size(size < 0 ? 255 : size);       //negative sizes are rejected as too large
             }
             break;
         }
-        case 'p':   //robot "press" - press the specified slot on the board
+        case 'm':   //robot "mode" - set the order that frets are glued and pressed in
         {
-            int num_slots = laser_module->get_num_slots();          //get the current number of slots
-            long* slot_buffer = laser_module->get_slot_buffer();    //get the list of slot indices
-            int index = (int) get_buffer_num(2);                    //get the target index from the buffer
-
-            if (index >= 0)
-            {
-                if (index < num_slots)                          //confirm the index refers to a real slot
-                {
-                    slide_module->motor->move_absolute(slot_buffer[index] + robot->PRESS_ALIGNMENT_OFFSET, true);
-                }
-                else
-                {
-                    Serial.println("Error: Specified slot index \"" + String(index) + "\" is larger than max slot index " + String(num_slots - 1));
-                }
-                press_module->press_slot();
-            }
-            else    //glue pass every slot in sequence
-            {
-                press_module->motor->move_absolute(5000, true); //move the press motor to the maximum limit
-                for (int i = 0; i < num_slots; i++)
-                {
-                    slide_module->motor->move_absolute(slot_buffer[i] + robot->PRESS_ALIGNMENT_OFFSET, true);
-                    press_module->press_slot();
-                }
-            }            break;
+            int mode = (int) get_buffer_num(2);                     //get the mode from the buffer
+            robot->set_process_mode(mode == 0 ? Robot::BATCH_MODE : mode == 1 ? Robot::PIPELINE_MODE : Robot::STREAM_MODE);
+            break;
         }
-        case 'b':   //robot "both" - glue and press frets along the entire board
+        case 'o':   //robot "order" - set which end of the board frets are glued and pressed from
         {
-            robot->press_frets();
+            int order = (int) get_buffer_num(2);                    //get the order from the buffer
+            robot->set_process_order(order == 0 ? Robot::FORWARD_ORDER : order == 1 ? Robot::REVERSE_ORDER : Robot::NEAREST_ORDER);
+            break;
+        }
+        case 'w':   //robot "window" - set whether slot detection slows down for the whole board, or only in windows around predicted slots
+        {
+            int mode = (int) get_buffer_num(2);                     //get the mode from the buffer
+            robot->set_scan_mode(mode == 0 ? UNIFORM_SCAN : ADAPTIVE_SCAN);
+            break;
+        }
+        case 'f':   //robot "fretboard (scale)" - set the range of scale lengths (steps) used to identify the frets detected
+        {
+            long min_scale = get_buffer_num(2);                     //number before the comma
+            int comma = 2;
+            while (command_buffer[comma] != 0 && command_buffer[comma] != ',') { comma++; }
+            long max_scale = command_buffer[comma] == ',' ? get_buffer_num(comma + 1) : min_scale;
+            robot->set_scale_range(min_scale, max_scale);
             break;
         }
         case 'a':   //robot "all" - perform all steps in the fret press process
@@ -558,16 +540,25 @@ void Utilities::robot_command()
             robot->reset();
             break;
         }
-        case 's':   //robot "save" - save the ALIGNMENT_OFFSET variables, and glue dry weight to EEPROM
+        case 's':   //robot "save" - save the ALIGNMENT_OFFSET variables, glue dry weight, batch size and scale length range to EEPROM
         {
             robot->save_offsets();
             glue_module->save_dry_weight();
+            robot->save_batch_size();
+            robot->save_scale_range();
             break;
         }
-        case 'l':   //robot "load" - load the ALIGNMENT_OFFSET variables, and glue dry weight from EEPROM
+        case 'l':   //robot "load" - load the ALIGNMENT_OFFSET variables, glue dry weight, batch size and scale length range from EEPROM
         {
             robot->load_offsets();
             glue_module->load_dry_weight();
+            robot->load_batch_size();
+            robot->load_scale_range();
+            break;
+        }
+        case 'q':   //robot "queary" - print out the current state of the robot
+        {
+            Serial.println(robot->str());
             break;
         }
         default: Serial.println("Unrecognized command for laser: \"" + String(action) + "\"");
@@ -592,11 +583,9 @@ void Utilities::reset_buffer()
 
 
 /**
-    Send the run() command to each motor so that they move while new commands can be read
+    Run every task on the robot so that motors and actions progress while new commands can be read
 */
-void Utilities::run_motors()
+void Utilities::run_tasks()
 {
-    slide_module->motor->run();
-    glue_module->motor->run();
-    press_module->motor->run();
+    robot->engine->run();
 }
\ No newline at end of file
@@ -70,7 +70,7 @@
     In the serial monitor command codes are used to control the robot. The following commands can be issued:
 
     Slide Command Controls:
-        sc       - "slide calibrate"        calibrate the slide stepper motor
+        sc       - "slide calibrate"        calibrate the slide stepper motor (runs in the background)
         sm<long> - "slide move (relative)"  moves the slide stepper to the specified (long) relative position
         sa<long> - "slide move (absolute)"  moves the slide stepper to the specified (long) absolute position
         ss       - "slide stop"             stops the slide stepper motor
@@ -79,20 +79,20 @@
         stp<int> - "slide target press"     moves the slide to align the press with the specified slot (int) (-1 for all slots)
                                             For each target command, slot indices start at 0, and end at num_slots-1
                                             Specifying the target as -1 will cause the slide to target every slot in order
-        sq       - "slide queary"           print out the current state of the slide_module (i.e. motor step position)
+        sq       - "slide queary"           print out the current state of the slide_module (i.e. motor step position, and worst step interrupt latency since the last query)
 
         <ENTER> with no text will immediately stop the slide motor (Doesn't work for target operations)
 
 
     Glue Command Controls:
-        gc       - "glue calibrate"         calibrate the glue stepper motor
+        gc       - "glue calibrate"         calibrate the glue stepper motor (runs in the background)
         gm<long> - "glue move (relative)"   moves the glue stepper to the specified (long) relative position
         ga<long> - "glue move (absolute)"   moves the glue stepper to the specified (long) absolute position
         gs       - "glue stop"              stops the glue stepper motor, and turn off the glue valve
         gt       - "glue toggle"            toggles the current state of the glue
         gg       - "glue go"                starts laying the glue
         gp       - "glue pause"             stops laying the glue
-        gq       - "glue queary"            print out the current state of the glue_module (i.e. motor step position, glue pneumatics state, and current glue weight)
+        gq       - "glue queary"            print out the current state of the glue_module (i.e. motor step position and step latency, glue pneumatics state, and current glue weight)
         gw       - "glue weight"            set the current weight to be the glue dry weight (i.e. subtracted off of all readings)
         go<int>  - "glue offset"            add the specified integer to GLUE_ALIGNMENT_OFFSET
 
@@ -100,14 +100,14 @@
 
 
     Press Command Controls:
-        pc       - "press calibrate"        calibrate the press stepper motor
+        pc       - "press calibrate"        calibrate the press stepper motor (runs in the background)
         pm<long> - "press move (relative)"  moves the press stepper to the specified (long) relative position
         pa<long> - "press move (absolute)"  moves the press stepper to the specified (long) absolute position
         ps       - "press stop"             stops the press stepper motor
         pt       - "press toggle"           toggles the current state of the press
         pl       - "press lower"            lowers the press arm
         pr       - "press raise"            raises the press arm
-        pq       - "press queary"           print out the current state of the press_module (i.e. motor step position, and press and snips pneumatics states)
+        pq       - "press queary"           print out the current state of the press_module (i.e. motor step position and step latency, and press and snips pneumatics states)
         po<int>  - "press offset"           add the specified integer to PRESS_ALIGNMENT_OFFSET
 
         <ENTER> with no text will stop the press stepper, open the snips and raise the press arm
@@ -123,30 +123,50 @@
     
 
     Laser Command Controls:
-        lc       - "laser calibrate"        calibrate the laser sensor
+        lc       - "laser calibrate"        calibrate the laser sensor (runs in the background)
         lt       - "laser toggle"           toggles the current state
         lh       - "laser high"             turns the laser on
         ll       - "laser low"              turns the laser off
         lq       - "laser queary"           print the current state of the laser emitter and sensor
         lo<int>  - "laser offset"           add the specified integer to LASER_ALIGNMENT_OFFSET
+        lx<int>  - "laser capture"          1 (default) to stream the raw samples of the next slot detection as a binary trace for LaserReplay, 0 to cancel.
+                                            The serial connection switches to CAPTURE_BAUD until the end of the board (or rr). See LaserReplay/README.md
     
         <ENTER> with no text will turn the laser off
 
     Robot Command Controls:
-        rc       - "robot calibrate"        calibrate all device on robot in sequence
-        ///NOT-IMPLEMENTED//// rb<int>  - "robot batch (size)"     set the number of slots glued and pressed at a single time. Currently, a batch size of 3 or 4 at the maximum due to glue drying time
+        rc       - "robot calibrate"        calibrate all devices on robot at the same time (every axis homes at once, while the laser is sampled)
+        rb<int>  - "robot batch (size)"     set the number of slots glued and pressed at a single time (1 to MAX_BATCH_SIZE). 
+                                            0 auto-tunes the batch size from measured glue/slide/press times, for the most frets per minute within the glue deadline.
+                                            Use rs to save the batch size to EEPROM. (rb with no number is "robot both" below)
         re       - "robot error"            check for any errors on the robot (e.g. out of glue or fret wire).
-        rr       - "robot reset"            reset all modules on the robot to the starting state
-        rd       - "robot detect"           perform steps to detect all slots
+        rr       - "robot reset"            reset all modules on the robot to the starting state. The parked motor positions are saved to EEPROM,
+                                            so if the robot is switched off now, the next calibration only has to verify them with a quick touch
+        rd       - "robot detect"           perform steps to detect all slots. The slots are fitted to the boards in the catalog (see BoardCatalog.h), with a scale
+                                            length in the range set by rf. If a board matches, slots that don't fit a fret are ignored, and missing frets between 
+                                            detected slots are filled in if the fit is tight (other missing frets are reported, and not pressed). 
+                                            Otherwise the slots are used as detected
+        rf<long>,<long> - "robot fretboard" set the range of scale lengths (in steps, i.e. scale length in mm times the slide's steps/mm) that rd fits
+                                            boards within, e.g. rf62865,64770 for 24.75" to 25.5" at 100 steps/mm. It must be narrower than a semitone
+                                            (max/min at most BOARD_MAX_SCALE_RATIO). rf0 clears it, so boards aren't identified. Use rs to save it to EEPROM
         rg<int>  - "robot glue"             perform an entire glue fret operation (rotate, glue) on the specified slot (-1 for all slots)
         rp<int>  - "robot press"            perform an entire press fret operation (rotate, press, lift, rotate, cut) on the specified slot (-1 for all slots)
         rb       - "robot both"             perform both fret gluing and pressing along the entire board
+        rm<int>  - "robot mode"             set the order frets are glued and pressed in. 0 for BATCH (glue a batch, then press it), 1 for PIPELINE (overlap glue/press where possible),
+                                            2 for STREAM (rd also glues/presses slots while scanning, and rb processes any slots left over)
+        ro<int>  - "robot order"            set which end of the board frets are glued and pressed from. 0 for FORWARD (first slot to last), 1 for REVERSE (last slot back to first),
+                                            2 for NEAREST (whichever end is nearest the slide, i.e. REVERSE right after rd). Glue/press overlap in PIPELINE mode only occurs in FORWARD order
+        rw<int>  - "robot window"           set how rd scans the board. 0 for UNIFORM (the whole board at SLIDE_SCAN_SPEED), 1 for ADAPTIVE (full speed between
+                                            windows around the slots predicted from those already seen, see ScanPlanner.h). Default is UNIFORM
         ra       - "robot all"              perform the entire fret press process (calibrate, reset, detect, glue/press) for a single fret board
         rq       - "robot queary"           print out the current state of the robot
-        rs       - "robot save"             save the current ALIGNMENT_OFFSET variables to EEPROM
-        rl       - "robot load"             load ALIGNMENT_OFFSET variables from EEPROM
+        rs       - "robot save"             save the current ALIGNMENT_OFFSET variables, glue dry weight, batch size and scale length range to EEPROM
+        rl       - "robot load"             load ALIGNMENT_OFFSET variables, glue dry weight, batch size and scale length range from EEPROM
 
-        WARNING: <ENTER> for all of the robot commands will have no effect as each commands blocks until they are finished
+        rg and rp run in the background, so other commands (e.g. sq, gq) can be issued while they are in progress.
+        <ENTER> with no text will cancel them, along with any background calibration, and stop every motor.
+
+        WARNING: <ENTER> for the rest of the robot commands will have no effect as each commands blocks until they are finished
 */
 class Utilities
 {
@@ -170,7 +190,7 @@ private:
     void laser_command();                       //commands for controlling the laser emmiter/sensor by theirself
     void robot_command();                       //commands for controlling the whole robot all at once
     void reset_buffer();                        //reset the serial buffer variables
-    void run_motors();                          //call run() for each stepper motor
+    void run_tasks();                           //call run() on the robot's task engine
 
     Robot* robot;                               //reference to the robot object containing all the modules
     LaserModule* laser_module;                  //reference to the main LaserModule